@@ -5,6 +5,7 @@
 #include <alkaidsd/intra_operator.h>
 #include <alkaidsd/ruin_method.h>
 #include <alkaidsd/sorter.h>
+#include <alkaidsd/statistics.h>
 
 #include <functional>
 #include <memory>
@@ -40,6 +41,36 @@ namespace alkaidsd {
      * @param objective The objective value of the final solution.
      */
     virtual void OnEnd(const AlkaidSolution &solution, int objective) = 0;
+
+    /**
+     * @brief Called before OnEnd if statistics collection or adaptive selection is enabled.
+     * @param statistics The statistics collected during the optimization process.
+     */
+    virtual void OnStatistics([[maybe_unused]] const Statistics &statistics) {}
+  };
+
+  /**
+   * @brief How the randomized variable neighborhood descent searches the inter-operators.
+   */
+  enum DescentMode {
+    kSequentialDescent, /**< Calls the operators one by one in the selector order and applies the
+                           move of the first one that improves the solution. */
+    kSpeculativeBest,   /**< Evaluates all operators concurrently on copies of the solution and
+                           applies the most improving move. */
+    kSpeculativeFirst   /**< Evaluates all operators concurrently on copies of the solution and
+                           applies the move of the first improving one in the selector order. */
+  };
+
+  /**
+   * @brief How the initial solution of a restart is built.
+   */
+  enum ConstructionMethod {
+    kCheapestInsertion, /**< Inserts the customers at their cheapest positions, filling the routes
+                           one by one or all in parallel. */
+    kSavings,           /**< Merges the routes of nearby customers by decreasing Clarke-Wright
+                           savings. */
+    kSweep              /**< Fills the routes with the customers in polar order around the depot,
+                           splitting the demands that do not fit. */
   };
 
   /**
@@ -49,6 +80,7 @@ namespace alkaidsd {
   struct Config {
     uint32_t random_seed; /**< The random seed for the optimization process. */
     double time_limit;    /**< The time limit (in seconds) for the optimization process. */
+    int num_threads = 1;  /**< The number of threads used by the optimization process. */
   };
 
   /**
@@ -57,6 +89,17 @@ namespace alkaidsd {
    */
   struct AlkaidConfig : public Config {
     double blink_rate;    /**< The blink rate for the SplitReinsertion process. */
+    std::vector<ConstructionMethod> construction_methods{
+        kCheapestInsertion}; /**< The methods building the initial solution of each restart, one
+                                picked uniformly at random per restart. Savings and sweep are much
+                                faster on large instances. */
+    int num_restart_candidates
+        = 1; /**< The number of initial solutions built at each restart, concurrently on the
+                thread pool. Each is improved by one local search descent and only the best one is
+                used by the iterated local search. 1 uses the first built solution as is. */
+    Node reinsertion_neighbors = 0; /**< The nearest neighbors of a customer whose routes
+                                       SplitReinsertion evaluates, besides the routes with the most
+                                       spare capacity. 0 evaluates every route. */
     std::vector<std::unique_ptr<inter_operator::InterOperator>>
         inter_operators; /**< The inter-operators for optimizing the solution. */
     std::vector<std::unique_ptr<intra_operator::IntraOperator>>
@@ -67,5 +110,17 @@ namespace alkaidsd {
         ruin_method;       /**< The ruin method for destroying parts of the solution. */
     sorter::Sorter sorter; /**< The sorter for sorting customers during the perturbation process. */
     std::unique_ptr<Listener> listener; /**< The listener for receiving optimization events. */
+    bool collect_statistics = false; /**< Whether to count operator statistics and report them to
+                                        the listener. */
+    bool adaptive_selection = false; /**< Whether to order operators by a roulette over their
+                                        recent improvement per microsecond instead of uniformly. */
+    double selection_decay
+        = 0.99; /**< The decay of the adaptive selection weights at each operator call. */
+    bool multi_start = false; /**< Whether to run num_threads independent restart loops with
+                                 their own random streams, sharing only the best solution, instead
+                                 of one loop using the threads in the local search. */
+    DescentMode descent_mode
+        = kSequentialDescent; /**< How the inter-operators are searched. Speculative modes run
+                                 the operators on the thread pool. */
   };
 }  // namespace alkaidsd
@@ -12,6 +12,27 @@ namespace alkaidsd {
 }  // namespace alkaidsd
 
 namespace alkaidsd::inter_operator {
+  /**
+   * @brief Strategies for scanning the route pairs of an inter-operator.
+   */
+  enum ScanStrategy {
+    kBestImprovement,  /**< Evaluates every route pair and applies the best move. */
+    kFirstImprovement, /**< Visits the route pairs in random order and applies the best move of
+                          the first pair that improves the solution. */
+    kSampledImprovement /**< Evaluates a random sample of the outdated route pairs, reuses the
+                           cached ones and applies the best move. */
+  };
+
+  /**
+   * @struct ScanPolicy
+   * @brief Controls how an inter-operator scans the route pairs.
+   */
+  struct ScanPolicy {
+    ScanStrategy strategy = kBestImprovement; /**< The scan strategy. */
+    double sample_rate
+        = 1.0; /**< The probability of evaluating an outdated route pair when sampling. */
+  };
+
   /**
    * @class InterOperator
    * @brief Base class for inter-route operators.
@@ -36,6 +57,15 @@ namespace alkaidsd::inter_operator {
     virtual std::vector<Node> operator()(const Instance &instance, AlkaidSolution &solution,
                                          RouteContext &context, Random &random,
                                          CacheMap &cache_map) const = 0;
+
+    /**
+     * @brief Sets how the operator scans the route pairs.
+     * @param scan_policy The scan policy.
+     */
+    void SetScanPolicy(const ScanPolicy &scan_policy) { scan_policy_ = scan_policy; }
+
+  protected:
+    ScanPolicy scan_policy_; /**< The scan policy of the operator. */
   };
 
   /**
@@ -46,8 +76,19 @@ namespace alkaidsd::inter_operator {
    */
   template <int num_x, int num_y> class Swap : public InterOperator {
   public:
+    /**
+     * @brief Constructor for Swap.
+     * @param num_neighbors The number of nearest neighbors per customer for granular search. Only
+     * moves that create an edge between a customer and one of its neighbors are evaluated. 0
+     * evaluates all moves.
+     */
+    explicit Swap(Node num_neighbors = 0) : num_neighbors_(num_neighbors) {}
+
     std::vector<Node> operator()(const Instance &instance, AlkaidSolution &solution, RouteContext &context,
                                  Random &random, CacheMap &cache_map) const override;
+
+  private:
+    Node num_neighbors_;
   };
 
   /**
@@ -56,8 +97,19 @@ namespace alkaidsd::inter_operator {
    */
   class Relocate : public InterOperator {
   public:
+    /**
+     * @brief Constructor for Relocate.
+     * @param num_neighbors The number of nearest neighbors per customer for granular search. Only
+     * moves that create an edge between a customer and one of its neighbors are evaluated. 0
+     * evaluates all moves.
+     */
+    explicit Relocate(Node num_neighbors = 0) : num_neighbors_(num_neighbors) {}
+
     std::vector<Node> operator()(const Instance &instance, AlkaidSolution &solution, RouteContext &context,
                                  Random &random, CacheMap &cache_map) const override;
+
+  private:
+    Node num_neighbors_;
   };
 
   /**
@@ -66,8 +118,22 @@ namespace alkaidsd::inter_operator {
    */
   class SwapStar : public InterOperator {
   public:
+    /**
+     * @brief Constructor for SwapStar.
+     * @param filter_route_pairs Whether to skip the route pairs whose bounding circles do not
+     * overlap.
+     * @param prune_route_pairs Whether to skip the route pairs whose lower bound on the delta is
+     * not negative.
+     */
+    explicit SwapStar(bool filter_route_pairs = false, bool prune_route_pairs = false)
+        : filter_route_pairs_(filter_route_pairs), prune_route_pairs_(prune_route_pairs) {}
+
     std::vector<Node> operator()(const Instance &instance, AlkaidSolution &solution, RouteContext &context,
                                  Random &random, CacheMap &cache_map) const override;
+
+  private:
+    bool filter_route_pairs_;
+    bool prune_route_pairs_;
   };
 
   /**
@@ -76,8 +142,23 @@ namespace alkaidsd::inter_operator {
    */
   class Cross : public InterOperator {
   public:
+    /**
+     * @brief Constructor for Cross.
+     * @param num_neighbors The number of nearest neighbors per customer for granular search. Only
+     * moves that create an edge between a customer and one of its neighbors are evaluated. 0
+     * evaluates all moves.
+     * @param filter_route_pairs Whether to skip the route pairs whose bounding circles do not
+     * overlap.
+     */
+    explicit Cross(Node num_neighbors = 0, bool filter_route_pairs = false)
+        : num_neighbors_(num_neighbors), filter_route_pairs_(filter_route_pairs) {}
+
     std::vector<Node> operator()(const Instance &instance, AlkaidSolution &solution, RouteContext &context,
                                  Random &random, CacheMap &cache_map) const override;
+
+  private:
+    Node num_neighbors_;
+    bool filter_route_pairs_;
   };
 
   /**
@@ -86,8 +167,22 @@ namespace alkaidsd::inter_operator {
    */
   class SdSwapStar : public InterOperator {
   public:
+    /**
+     * @brief Constructor for SdSwapStar.
+     * @param filter_route_pairs Whether to skip the route pairs whose bounding circles do not
+     * overlap.
+     * @param prune_route_pairs Whether to skip the route pairs whose lower bound on the delta is
+     * not negative.
+     */
+    explicit SdSwapStar(bool filter_route_pairs = false, bool prune_route_pairs = false)
+        : filter_route_pairs_(filter_route_pairs), prune_route_pairs_(prune_route_pairs) {}
+
     std::vector<Node> operator()(const Instance &instance, AlkaidSolution &solution, RouteContext &context,
                                  Random &random, CacheMap &cache_map) const override;
+
+  private:
+    bool filter_route_pairs_;
+    bool prune_route_pairs_;
   };
 
   /**
@@ -97,8 +192,19 @@ namespace alkaidsd::inter_operator {
    */
   class SdSwapOneOne : public InterOperator {
   public:
+    /**
+     * @brief Constructor for SdSwapOneOne.
+     * @param num_neighbors The number of nearest neighbors per customer for granular search. Only
+     * moves that create an edge between a customer and one of its neighbors are evaluated. 0
+     * evaluates all moves.
+     */
+    explicit SdSwapOneOne(Node num_neighbors = 0) : num_neighbors_(num_neighbors) {}
+
     std::vector<Node> operator()(const Instance &instance, AlkaidSolution &solution, RouteContext &context,
                                  Random &random, CacheMap &cache_map) const override;
+
+  private:
+    Node num_neighbors_;
   };
 
   /**
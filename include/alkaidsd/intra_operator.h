@@ -3,6 +3,7 @@
 #include <alkaidsd/instance.h>
 #include <alkaidsd/solution.h>
 
+#include <algorithm>
 #include <vector>
 
 namespace alkaidsd {
@@ -32,6 +33,13 @@ namespace alkaidsd::intra_operator {
      */
     virtual bool operator()(const Instance &instance, Node route_index, AlkaidSolution &solution,
                             RouteContext &context, Random &random) const = 0;
+
+    /**
+     * @brief Checks whether the operator leaves a route with the given number of nodes optimal.
+     * @param num_nodes The number of nodes in the route.
+     * @return True if a single call solves the route exactly, false otherwise.
+     */
+    virtual bool IsExact([[maybe_unused]] Node num_nodes) const { return false; }
   };
 
   /**
@@ -55,4 +63,51 @@ namespace alkaidsd::intra_operator {
     bool operator()(const Instance &instance, Node route_index, AlkaidSolution &solution,
                     RouteContext &context, Random &random) const override;
   };
+
+  /**
+   * @brief Intra-route operator that performs the 2-opt move on a route.
+   *
+   * This operator reverses a segment of a route. Prefix distances in both directions make every
+   * move O(1) to evaluate, also for asymmetric distance matrices.
+   */
+  class TwoOpt : public IntraOperator {
+  public:
+    /**
+     * @brief Constructs a TwoOpt operator.
+     * @param sparsification If positive, only moves creating an edge no longer than this factor
+     * times the average edge length of the route are evaluated (granular 2-opt).
+     */
+    explicit TwoOpt(double sparsification = 0) : sparsification_(sparsification) {}
+    bool operator()(const Instance &instance, Node route_index, AlkaidSolution &solution,
+                    RouteContext &context, Random &random) const override;
+
+  private:
+    double sparsification_;
+  };
+
+  /**
+   * @brief Intra-route operator that solves short routes exactly.
+   *
+   * This operator finds the optimal order of a route with at most `max_size` nodes by the
+   * Held-Karp dynamic program over subsets. Longer routes are left to the other operators.
+   */
+  class HeldKarp : public IntraOperator {
+  public:
+    /**
+     * @brief The largest supported route size.
+     */
+    static constexpr Node kMaxSize = 16;
+
+    /**
+     * @brief Constructs a HeldKarp operator.
+     * @param max_size The largest route size solved exactly, at most kMaxSize.
+     */
+    explicit HeldKarp(Node max_size = 10) : max_size_(std::min(max_size, kMaxSize)) {}
+    bool operator()(const Instance &instance, Node route_index, AlkaidSolution &solution,
+                    RouteContext &context, Random &random) const override;
+    bool IsExact(Node num_nodes) const override { return num_nodes <= max_size_; }
+
+  private:
+    Node max_size_;
+  };
 }  // namespace alkaidsd::intra_operator
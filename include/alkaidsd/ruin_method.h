@@ -24,6 +24,15 @@ namespace alkaidsd::ruin_method {
      */
     virtual ~RuinMethod() = default;
 
+    /**
+     * @brief Prepares the ruin method for an instance.
+     *
+     * The solver calls it once per solve, before any call to Ruin, with the instance it searches.
+     *
+     * @param instance The problem instance.
+     */
+    virtual void Reset([[maybe_unused]] const Instance &instance) {}
+
     /**
      * @brief Ruin the solution by removing nodes.
      *
@@ -70,7 +79,10 @@ namespace alkaidsd::ruin_method {
    * algorithm.
    *
    * This class implements the RuinMethod interface and provides a ruin method based on the SISRs
-   * algorithm.
+   * algorithm. The customers are visited by their distance to the seed customer through adjacency
+   * lists of the nearest customers sorted once per instance, so a call only walks the neighborhood
+   * it ruins. The lists are built by Reset, or by the first call to Ruin for an instance with
+   * another number of customers when Reset was not called.
    */
   class SisrsRuin : public RuinMethod {
   public:
@@ -85,15 +97,22 @@ namespace alkaidsd::ruin_method {
     SisrsRuin(int average_customers, int max_length, double split_rate,
               double preserved_probability);
 
+    void Reset(const Instance &instance) override;
+
     std::vector<Node> Ruin(const Instance &instance, AlkaidSolution &solution, RouteContext &context,
                            Random &random) override;
 
   private:
+    void SortFarNeighbors(const Instance &instance, Node customer,
+                          std::vector<Node> &neighbors) const;
     static Node GetRouteHead(AlkaidSolution &solution, Node node_index, int &position);
     static void GetRoute(const AlkaidSolution &solution, Node head, std::vector<Node> &route);
     int average_customers_;
     int max_length_;
     double split_rate_;
     double preserved_probability_;
+    Node num_customers_{};
+    Node num_neighbors_{};
+    std::vector<Node> neighbors_;
   };
 }  // namespace alkaidsd::ruin_method
@@ -22,4 +22,37 @@ namespace alkaidsd {
     /// @return The solution to the problem instance.
     AlkaidSolution Solve(const AlkaidConfig &config, const Instance &instance) override;
   };
+
+  /// @brief A list of types fixed at compile time.
+  template <class... Types> struct TypeList {};
+
+  /// @brief Solver whose inter operators, intra operators, acceptance rule and ruin method are
+  /// fixed at compile time, so that they are called without virtual dispatch.
+  ///
+  /// The config must hold exactly these types in the same order, with any parameters. Only the
+  /// instantiations declared below are built into the library.
+  /// @tparam InterOperators The TypeList of the inter operators.
+  /// @tparam IntraOperators The TypeList of the intra operators.
+  /// @tparam AcceptanceRuleType The type of the acceptance rule.
+  /// @tparam RuinMethodType The type of the ruin method.
+  template <class InterOperators, class IntraOperators, class AcceptanceRuleType,
+            class RuinMethodType>
+  class AlkaidSolverT : public Solver<AlkaidSolution, AlkaidConfig, Instance> {
+  public:
+    /// @brief Main function for solving the problem instance.
+    /// @param config The configuration.
+    /// @param instance The problem instance.
+    /// @return The solution to the problem instance.
+    /// @throw std::invalid_argument If the config does not hold the types of the solver.
+    AlkaidSolution Solve(const AlkaidConfig &config, const Instance &instance) override;
+  };
+
+  /// @brief The static solver for the operators, acceptance rule and ruin method of
+  /// example-config.ini.
+  using ExampleConfigSolver = AlkaidSolverT<
+      TypeList<inter_operator::Relocate, inter_operator::Swap<2, 0>, inter_operator::Swap<2, 1>,
+               inter_operator::Swap<2, 2>, inter_operator::Cross, inter_operator::SwapStar,
+               inter_operator::SdSwapStar>,
+      TypeList<intra_operator::Exchange, intra_operator::OrOpt<1>>,
+      acceptance_rule::LateAcceptanceHillClimbing, ruin_method::SisrsRuin>;
 }  // namespace alkaidsd
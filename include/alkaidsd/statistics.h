@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace alkaidsd {
+  /**
+   * @struct OperatorStatistics
+   * @brief Counters collected for an operator during the optimization process. Intra-operators
+   * only fill the calls, improvements and weight.
+   */
+  struct OperatorStatistics {
+    uint64_t num_calls = 0;        /**< The number of times the operator was called. */
+    uint64_t num_improvements = 0; /**< The number of calls that improved the solution. */
+    uint64_t num_cache_hits = 0;   /**< The number of route pairs reused from the pair caches. */
+    uint64_t num_cache_misses = 0; /**< The number of route pairs evaluated from scratch. */
+    uint64_t num_cache_invalidations
+        = 0; /**< The number of pair caches re-evaluated because one of their routes changed. */
+    uint64_t num_preprocesses = 0; /**< The number of route preprocesses run by the operator. */
+    uint64_t num_evaluations = 0;  /**< The number of evaluated moves. */
+    uint64_t num_filtered_pairs
+        = 0; /**< The number of route pairs skipped by bounding circles or lower bounds. */
+    double weight = 0; /**< The final adaptive selection weight, 0 without adaptive selection.
+                          Averaged over the restart loops in multi-start mode. */
+  };
+
+  /**
+   * @struct Statistics
+   * @brief Statistics collected during the optimization process.
+   */
+  struct Statistics {
+    std::vector<OperatorStatistics>
+        inter_operators; /**< The statistics of each inter-operator, in configuration order. */
+    std::vector<OperatorStatistics>
+        intra_operators; /**< The statistics of each intra-operator, in configuration order. */
+  };
+}  // namespace alkaidsd
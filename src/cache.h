@@ -2,13 +2,18 @@
 
 #include <alkaidsd/instance.h>
 #include <alkaidsd/solution.h>
+#include <alkaidsd/statistics.h>
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <typeindex>
-#include <unordered_map>
 #include <utility>
 
+#include "random.h"
 #include "route_context.h"
+#include "thread_pool.h"
 
 namespace alkaidsd {
   class Cache {
@@ -18,21 +23,28 @@ namespace alkaidsd {
         = 0;
     virtual void AddRoute(alkaidsd::Node route_index) = 0;
     virtual void RemoveRoute(alkaidsd::Node route_index) = 0;
-    virtual void MoveRoute(alkaidsd::Node dest_route_index, alkaidsd::Node src_route_index) = 0;
     virtual void Save(const alkaidsd::AlkaidSolution &solution, const alkaidsd::RouteContext &context)
         = 0;
+    virtual void Warmup([[maybe_unused]] const alkaidsd::Instance &instance,
+                        [[maybe_unused]] const alkaidsd::AlkaidSolution &solution,
+                        [[maybe_unused]] const alkaidsd::RouteContext &context,
+                        [[maybe_unused]] alkaidsd::Random &random,
+                        [[maybe_unused]] alkaidsd::ThreadPool &thread_pool) {}
   };
 
   class CacheMap : public Cache {
   public:
+    // The cache of type T, created on first use. Distinct keys give distinct caches of a type.
     template <class T>
-    T &Get(const alkaidsd::AlkaidSolution &solution, const alkaidsd::RouteContext &context) {
-      auto it = caches_.find(typeid(T));
+    T &Get(const alkaidsd::AlkaidSolution &solution, const alkaidsd::RouteContext &context,
+           int key = 0) {
+      std::lock_guard<std::mutex> lock(map_mutex_);
+      auto it = caches_.find({typeid(T), key});
       if (it == caches_.end()) {
         auto cache = std::make_unique<T>();
         cache->Reset(solution, context);
         auto &cache_ref = *cache;
-        caches_.emplace(typeid(T), std::move(cache));
+        caches_.emplace(std::pair<std::type_index, int>(typeid(T), key), std::move(cache));
         return cache_ref;
       }
       return *static_cast<T *>(it->second.get());
@@ -52,18 +64,68 @@ namespace alkaidsd {
         cache->RemoveRoute(route_index);
       }
     }
-    void MoveRoute(alkaidsd::Node dest_route_index, alkaidsd::Node src_route_index) override {
+    void Save(const alkaidsd::AlkaidSolution &solution, const alkaidsd::RouteContext &context) override {
       for (auto &[_, cache] : caches_) {
-        cache->MoveRoute(dest_route_index, src_route_index);
+        cache->Save(solution, context);
       }
     }
-    void Save(const alkaidsd::AlkaidSolution &solution, const alkaidsd::RouteContext &context) override {
+    void Warmup(const alkaidsd::Instance &instance, const alkaidsd::AlkaidSolution &solution,
+                const alkaidsd::RouteContext &context, alkaidsd::Random &random,
+                alkaidsd::ThreadPool &thread_pool) override {
       for (auto &[_, cache] : caches_) {
-        cache->Save(solution, context);
+        cache->Warmup(instance, solution, context, random, thread_pool);
+      }
+    }
+    bool Empty() const { return caches_.empty(); }
+    // The counters of the operator being called on this thread with this cache map, or null when
+    // statistics are not collected. They are bound once per operator call, so that counting costs
+    // nothing by default.
+    alkaidsd::OperatorStatistics *Statistics() const {
+      return bound_cache_map_ == this ? bound_statistics_ : nullptr;
+    }
+    // Binds the counters to the operators called on this thread with the cache map, until the
+    // scope ends.
+    class StatisticsScope {
+    public:
+      StatisticsScope(const CacheMap &cache_map, alkaidsd::OperatorStatistics *statistics)
+          : previous_cache_map_(bound_cache_map_), previous_statistics_(bound_statistics_) {
+        bound_cache_map_ = &cache_map;
+        bound_statistics_ = statistics;
+      }
+      ~StatisticsScope() {
+        bound_cache_map_ = previous_cache_map_;
+        bound_statistics_ = previous_statistics_;
+      }
+      StatisticsScope(const StatisticsScope &) = delete;
+      StatisticsScope &operator=(const StatisticsScope &) = delete;
+
+    private:
+      const CacheMap *previous_cache_map_;
+      alkaidsd::OperatorStatistics *previous_statistics_;
+    };
+    // Guards the serial parts of the operators, where the caches shared between operators are
+    // updated, when several operators are evaluated concurrently.
+    std::mutex &Mutex() { return mutex_; }
+    // The pool operators evaluate route pairs on. Without one, ParallelFor runs serially.
+    void SetThreadPool(alkaidsd::ThreadPool &thread_pool) { thread_pool_ = &thread_pool; }
+    void ParallelFor(int n, const std::function<void(int)> &func) {
+      if (thread_pool_) {
+        thread_pool_->ParallelFor(n, func);
+      } else {
+        for (int i = 0; i < n; ++i) {
+          func(i);
+        }
       }
     }
 
   private:
-    std::unordered_map<std::type_index, std::unique_ptr<Cache>> caches_;
+    std::map<std::pair<std::type_index, int>, std::unique_ptr<Cache>> caches_;
+    // Per thread, as concurrent operators count into their own statistics, and only set while a
+    // StatisticsScope is alive.
+    inline static thread_local const CacheMap *bound_cache_map_{};
+    inline static thread_local alkaidsd::OperatorStatistics *bound_statistics_{};
+    alkaidsd::ThreadPool *thread_pool_{};
+    std::mutex map_mutex_;
+    std::mutex mutex_;
   };
 }  // namespace alkaidsd
@@ -1,7 +1,13 @@
 #include "construction.h"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <limits>
 #include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -28,7 +34,8 @@ namespace alkaidsd {
 
   template <class Func> void SequentialInsertion(const Instance &instance, const Func &func,
                                                  CandidateList &candidate_list, Random &random,
-                                                 AlkaidSolution &solution, RouteContext &context) {
+                                                 AlkaidSolution &solution, RouteContext &context,
+                                                 inter_operator::RouteArrays &route_arrays) {
     InsertionWithCost<float> best_insertion{};
     std::vector<bool> is_full(context.NumRoutes(), false);
     while (!candidate_list.empty()) {
@@ -44,8 +51,8 @@ namespace alkaidsd {
           if (context.Load(route_index) + demand > instance.capacity) {
             continue;
           }
-          auto insertion
-              = CalcBestInsertion(solution, func, context, route_index, customer, random);
+          auto insertion = CalcBestInsertionBatch(instance, solution, func, context,
+                                                  route_arrays, route_index, customer, random);
           if (best_insertion.Update(insertion, random)) {
             candidate_position = i;
           }
@@ -62,86 +69,109 @@ namespace alkaidsd {
             context.SetHead(route_index, node_index);
           }
           context.AddLoad(route_index, demand);
+          route_arrays.AddRoute(route_index);
           inserted = true;
         }
       }
       if (!inserted) {
         AddRoute(candidate_list, random, solution, context);
+        route_arrays.AddRoute(context.NumRoutes() - 1);
         is_full.push_back(false);
       }
     }
   }
 
+  // Inserts the globally cheapest (candidate, route) pair each time. The pairs wait in a heap and
+  // are invalidated lazily: a change to a route bumps its version and pushes fresh pairs for that
+  // route only, while stale, inserted and capacity-infeasible pairs are dropped when popped. Equal
+  // costs are ordered by a random key.
   template <class Func> void ParallelInsertion(const Instance &instance, const Func &func,
                                                CandidateList &candidate_list, Random &random,
-                                               AlkaidSolution &solution, RouteContext &context) {
-    std::vector<std::vector<InsertionWithCost<float>>> best_insertions(candidate_list.size());
-    for (int i = 0; i < static_cast<int>(candidate_list.size()); ++i) {
-      for (Node j = 0; j < context.NumRoutes(); ++j) {
-        best_insertions[i].push_back(
-            CalcBestInsertion(solution, func, context, j, candidate_list[i].first, random));
+                                               AlkaidSolution &solution, RouteContext &context,
+                                               inter_operator::RouteArrays &route_arrays) {
+    struct Entry {
+      InsertionWithCost<float> insertion;
+      uint32_t key;
+      int candidate;
+      int version;
+      bool operator>(const Entry &other) const {
+        return std::tie(insertion.cost.value, key) > std::tie(other.insertion.cost.value, other.key);
+      }
+    };
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap;
+    std::vector<int> versions(context.NumRoutes());
+    std::vector<int> remaining(candidate_list.size());
+    std::vector<int> positions(candidate_list.size());
+    std::iota(remaining.begin(), remaining.end(), 0);
+    std::iota(positions.begin(), positions.end(), 0);
+    auto push = [&](int candidate, Node route_index) {
+      auto [customer, demand] = candidate_list[candidate];
+      if (context.Load(route_index) + demand <= instance.capacity) {
+        heap.push({CalcBestInsertionBatch(instance, solution, func, context, route_arrays,
+                                          route_index, customer, random),
+                   random.NextSeed(), candidate, versions[route_index]});
+      }
+    };
+    auto remove = [&](int candidate) {
+      int position = positions[candidate];
+      remaining[position] = remaining.back();
+      positions[remaining[position]] = position;
+      remaining.pop_back();
+      positions[candidate] = -1;
+    };
+    for (int candidate : remaining) {
+      for (Node route_index = 0; route_index < context.NumRoutes(); ++route_index) {
+        push(candidate, route_index);
       }
     }
-    std::vector<bool> updated(context.NumRoutes(), false);
-    InsertionWithCost<float> best_insertion{};
-    while (!candidate_list.empty()) {
-      int candidate_position = -1;
-      best_insertion.cost = Delta(std::numeric_limits<float>::max(), -1);
-      for (int i = 0; i < static_cast<int>(best_insertions.size()); ++i) {
-        for (int j = 0; j < static_cast<int>(best_insertions[i].size()); ++j) {
-          Node route_index = best_insertions[i][j].route_index;
-          auto [customer, demand] = candidate_list[i];
-          if (context.Load(route_index) + demand > instance.capacity) {
-            best_insertions[i][j] = best_insertions[i].back();
-            best_insertions[i].pop_back();
-            --j;
-          } else {
-            if (updated[route_index]) {
-              best_insertions[i][j]
-                  = CalcBestInsertion(solution, func, context, route_index, customer, random);
-            }
-            if (best_insertion.Update(best_insertions[i][j], random)) {
-              candidate_position = i;
-            }
-          }
+    while (!remaining.empty()) {
+      if (heap.empty()) {
+        int candidate = remaining[random.NextInt(0, static_cast<int>(remaining.size()) - 1)];
+        auto [customer, demand] = candidate_list[candidate];
+        Node node_index = solution.Insert(customer, demand, 0, 0);
+        Node route_index = context.AddRoute(node_index, node_index, demand);
+        route_arrays.AddRoute(route_index);
+        remove(candidate);
+        versions.resize(context.NumRoutes());
+        for (int other : remaining) {
+          push(other, route_index);
         }
+        continue;
       }
-      if (candidate_position == -1) {
-        int position = AddRoute(candidate_list, random, solution, context);
-        best_insertions[position] = std::move(best_insertions.back());
-        best_insertions.pop_back();
-        for (int i = 0; i < static_cast<int>(candidate_list.size()); ++i) {
-          auto [customer, demand] = candidate_list[i];
-          best_insertions[i].push_back(CalcBestInsertion(
-              solution, func, context, context.NumRoutes() - 1, customer, random));
-        }
-        updated.push_back(false);
-      } else {
-        auto [customer, demand] = candidate_list[candidate_position];
-        candidate_list[candidate_position] = candidate_list.back();
-        candidate_list.pop_back();
-        best_insertions[candidate_position] = std::move(best_insertions.back());
-        best_insertions.pop_back();
-        Node node_index = solution.Insert(customer, demand, best_insertion.predecessor,
-                                          best_insertion.successor);
-        Node route_index = best_insertion.route_index;
-        if (best_insertion.predecessor == 0) {
-          context.SetHead(route_index, node_index);
-        }
-        context.AddLoad(route_index, demand);
-        updated[route_index] = true;
+      Entry entry = heap.top();
+      heap.pop();
+      Node route_index = entry.insertion.route_index;
+      auto [customer, demand] = candidate_list[entry.candidate];
+      if (positions[entry.candidate] == -1 || entry.version != versions[route_index]
+          || context.Load(route_index) + demand > instance.capacity) {
+        continue;
+      }
+      Node node_index = solution.Insert(customer, demand, entry.insertion.predecessor,
+                                        entry.insertion.successor);
+      if (entry.insertion.predecessor == 0) {
+        context.SetHead(route_index, node_index);
+      }
+      context.AddLoad(route_index, demand);
+      route_arrays.AddRoute(route_index);
+      remove(entry.candidate);
+      ++versions[route_index];
+      for (int other : remaining) {
+        push(other, route_index);
       }
     }
+    candidate_list.clear();
   }
 
   template <class Func> void InsertCandidates(const Instance &instance, const Func &func,
                                               CandidateList &candidate_list, Random &random,
                                               AlkaidSolution &solution, RouteContext &context) {
     int strategy = random.NextInt(0, 1);
+    inter_operator::RouteArrays route_arrays;
+    route_arrays.Reset(solution, context);
     if (strategy == kSis) {
-      SequentialInsertion(instance, func, candidate_list, random, solution, context);
+      SequentialInsertion(instance, func, candidate_list, random, solution, context, route_arrays);
     } else {
-      ParallelInsertion(instance, func, candidate_list, random, solution, context);
+      ParallelInsertion(instance, func, candidate_list, random, solution, context, route_arrays);
     }
   }
 
@@ -164,18 +194,15 @@ namespace alkaidsd {
     int criterion = random.NextInt(0, 1);
     if (criterion == kMcfic) {
       float gamma = static_cast<float>(random.NextInt(0, 34)) * 0.05f;
-      auto func = [&](Node predecessor, Node successor, Node customer) {
-        Node pre_customer = solution.Customer(predecessor);
-        Node suc_customer = solution.Customer(successor);
+      auto func = [&](Node pre_customer, Node suc_customer, int length, Node customer) {
         return static_cast<float>(instance.distance_matrix[pre_customer][customer]
-                                  + instance.distance_matrix[customer][suc_customer]
-                                  - instance.distance_matrix[pre_customer][suc_customer])
+                                  + instance.distance_matrix[customer][suc_customer] - length)
                - 2 * gamma * instance.distance_matrix[0][customer];
       };
       InsertCandidates(instance, func, candidate_list, random, solution, context);
     } else {
-      auto func = [&](Node predecessor, [[maybe_unused]] Node successor, Node customer) {
-        Node pre_customer = solution.Customer(predecessor);
+      auto func = [&](Node pre_customer, [[maybe_unused]] Node suc_customer,
+                      [[maybe_unused]] int length, Node customer) {
         if (pre_customer == 0) {
           return std::numeric_limits<float>::max();
         } else {
@@ -186,4 +213,229 @@ namespace alkaidsd {
     }
     return solution;
   }
+
+  // Serves every full capacity of a demand by a direct trip and returns the remaining demands.
+  std::vector<int> AddFullLoadTrips(const Instance &instance, AlkaidSolution &solution) {
+    std::vector<int> remaining_demands(instance.num_customers);
+    for (Node i = 1; i < instance.num_customers; ++i) {
+      for (int j = 0; j < instance.demands[i] / instance.capacity; ++j) {
+        solution.Insert(i, instance.capacity, 0, 0);
+      }
+      remaining_demands[i] = instance.demands[i] % instance.capacity;
+    }
+    return remaining_demands;
+  }
+
+  Constructor::Constructor(const Instance &instance, std::vector<ConstructionMethod> methods)
+      : methods_(std::move(methods)) {
+    if (methods_.empty()) {
+      throw std::invalid_argument("No construction method.");
+    }
+    auto &&distance_matrix = instance.distance_matrix;
+    if (std::find(methods_.begin(), methods_.end(), kSavings) != methods_.end()) {
+      // Only the savings of the nearest customers are considered, which are kept in a bounded
+      // max-heap while scanning the distances. Customers come in increasing order, so a tie with
+      // the farthest kept customer never replaces it.
+      constexpr Node kNumSavingsNeighbors = 32;
+      num_neighbors_ = std::max(0, std::min<int>(kNumSavingsNeighbors, instance.num_customers - 2));
+      neighbors_.resize(static_cast<size_t>(instance.num_customers) * num_neighbors_);
+      std::vector<std::pair<int, Node>> heap;
+      for (Node customer = 1; num_neighbors_ > 0 && customer < instance.num_customers; ++customer) {
+        const int *distances = distance_matrix[customer].data();
+        heap.clear();
+        int bound = std::numeric_limits<int>::max();
+        for (Node other = 1; other < instance.num_customers; ++other) {
+          if (distances[other] >= bound || other == customer) {
+            continue;
+          }
+          if (static_cast<Node>(heap.size()) == num_neighbors_) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+          }
+          heap.emplace_back(distances[other], other);
+          std::push_heap(heap.begin(), heap.end());
+          if (static_cast<Node>(heap.size()) == num_neighbors_) {
+            bound = heap.front().first;
+          }
+        }
+        std::sort_heap(heap.begin(), heap.end());
+        for (Node i = 0; i < num_neighbors_; ++i) {
+          neighbors_[static_cast<size_t>(customer) * num_neighbors_ + i] = heap[i].second;
+        }
+      }
+    }
+    if (std::find(methods_.begin(), methods_.end(), kSweep) != methods_.end()) {
+      // The instance only has distances, so planar coordinates are recovered with the depot at
+      // the origin and the farthest customer on the x-axis. The side of the axis is chosen by the
+      // distance to the customer farthest from the axis. This is exact for Euclidean instances.
+      std::vector<double> x(instance.num_customers), y(instance.num_customers);
+      Node axis_customer = 0;
+      for (Node customer = 1; customer < instance.num_customers; ++customer) {
+        if (distance_matrix[0][customer] > distance_matrix[0][axis_customer]) {
+          axis_customer = customer;
+        }
+      }
+      double axis_length = distance_matrix[0][axis_customer];
+      Node side_customer = 0;
+      if (axis_length > 0) {
+        for (Node customer = 1; customer < instance.num_customers; ++customer) {
+          double distance = distance_matrix[0][customer];
+          double axis_distance = distance_matrix[axis_customer][customer];
+          x[customer] = (distance * distance + axis_length * axis_length
+                         - axis_distance * axis_distance)
+                        / (2 * axis_length);
+          y[customer] = std::sqrt(std::max(0.0, distance * distance - x[customer] * x[customer]));
+          if (y[customer] > y[side_customer]) {
+            side_customer = customer;
+          }
+        }
+      }
+      for (Node customer = 1; customer < instance.num_customers; ++customer) {
+        double distance = distance_matrix[side_customer][customer];
+        double dx = x[customer] - x[side_customer];
+        if (std::abs(std::hypot(dx, y[customer] - y[side_customer]) - distance)
+            > std::abs(std::hypot(dx, y[customer] + y[side_customer]) - distance)) {
+          y[customer] = -y[customer];
+        }
+      }
+      std::vector<double> angles(instance.num_customers);
+      for (Node customer = 1; customer < instance.num_customers; ++customer) {
+        angles[customer] = std::atan2(y[customer], x[customer]);
+        polar_order_.push_back(customer);
+      }
+      std::sort(polar_order_.begin(), polar_order_.end(), [&](Node lhs, Node rhs) {
+        return std::tie(angles[lhs], distance_matrix[0][lhs], lhs)
+               < std::tie(angles[rhs], distance_matrix[0][rhs], rhs);
+      });
+    }
+  }
+
+  AlkaidSolution Constructor::Construct(const Instance &instance, Random &random) const {
+    ConstructionMethod method
+        = methods_.size() == 1
+              ? methods_[0]
+              : methods_[random.NextInt(0, static_cast<int>(methods_.size()) - 1)];
+    switch (method) {
+      case kSavings:
+        return Savings(instance, random);
+      case kSweep:
+        return Sweep(instance, random);
+      default:
+        return alkaidsd::Construct(instance, random);
+    }
+  }
+
+  // Clarke-Wright savings: the customers start on their own routes and the pairs of nearby route
+  // ends are merged in decreasing order of d(0, i) + d(0, j) - lambda * d(i, j), taken from a heap.
+  // Lambda is drawn for each construction.
+  AlkaidSolution Constructor::Savings(const Instance &instance, Random &random) const {
+    struct Saving {
+      float value;
+      uint32_t key;
+      Node first;
+      Node second;
+      bool operator<(const Saving &other) const {
+        return std::tie(value, key) < std::tie(other.value, other.key);
+      }
+    };
+    AlkaidSolution solution;
+    auto loads = AddFullLoadTrips(instance, solution);
+    auto &&distance_matrix = instance.distance_matrix;
+    float lambda = static_cast<float>(random.NextInt(5, 15)) * 0.1f;
+    std::vector<Saving> savings;
+    for (Node customer = 1; customer < instance.num_customers; ++customer) {
+      if (loads[customer] == 0) {
+        continue;
+      }
+      for (Node i = 0; i < num_neighbors_; ++i) {
+        Node other = neighbors_[static_cast<size_t>(customer) * num_neighbors_ + i];
+        if (other < customer || loads[other] == 0) {
+          continue;
+        }
+        float value = static_cast<float>(distance_matrix[0][customer] + distance_matrix[0][other])
+                      - lambda * static_cast<float>(distance_matrix[customer][other]);
+        if (value > 0) {
+          savings.push_back({value, random.NextSeed(), customer, other});
+        }
+      }
+    }
+    std::priority_queue<Saving> heap(std::less<Saving>(), std::move(savings));
+    // The routes are kept as undirected paths with a union-find over their customers, so that
+    // merging two ends never reverses a route.
+    std::vector<std::pair<Node, Node>> links(instance.num_customers);
+    std::vector<Node> parents(instance.num_customers);
+    std::vector<int> route_loads = loads;
+    std::iota(parents.begin(), parents.end(), 0);
+    auto find = [&](Node customer) {
+      while (parents[customer] != customer) {
+        customer = parents[customer] = parents[parents[customer]];
+      }
+      return customer;
+    };
+    auto link = [&](Node customer, Node other) {
+      (links[customer].first ? links[customer].second : links[customer].first) = other;
+    };
+    while (!heap.empty()) {
+      Node first = heap.top().first;
+      Node second = heap.top().second;
+      heap.pop();
+      Node first_root = find(first);
+      Node second_root = find(second);
+      if (first_root == second_root || links[first].second || links[second].second
+          || route_loads[first_root] + route_loads[second_root] > instance.capacity) {
+        continue;
+      }
+      link(first, second);
+      link(second, first);
+      parents[second_root] = first_root;
+      route_loads[first_root] += route_loads[second_root];
+    }
+    std::vector<bool> visited(instance.num_customers);
+    for (Node customer = 1; customer < instance.num_customers; ++customer) {
+      if (loads[customer] == 0 || visited[customer] || links[customer].second) {
+        continue;
+      }
+      Node predecessor = 0;
+      Node node_index = 0;
+      for (Node current = customer; current;) {
+        visited[current] = true;
+        node_index = solution.Insert(current, loads[current], node_index, 0);
+        Node next = links[current].first == predecessor ? links[current].second
+                                                        : links[current].first;
+        predecessor = current;
+        current = next;
+      }
+    }
+    return solution;
+  }
+
+  // Fills the routes with the customers in polar order from a random customer and in a random
+  // direction. A demand that does not fit is split, and its rest starts the next route.
+  AlkaidSolution Constructor::Sweep(const Instance &instance, Random &random) const {
+    AlkaidSolution solution;
+    auto remaining_demands = AddFullLoadTrips(instance, solution);
+    int size = static_cast<int>(polar_order_.size());
+    if (size == 0) {
+      return solution;
+    }
+    int start = random.NextInt(0, size - 1);
+    int step = random.NextInt(0, 1) ? 1 : size - 1;
+    Node node_index = 0;
+    int load = 0;
+    for (int i = 0, position = start; i < size; ++i, position = (position + step) % size) {
+      Node customer = polar_order_[position];
+      int demand = remaining_demands[customer];
+      while (demand > 0) {
+        if (load == instance.capacity) {
+          node_index = 0;
+          load = 0;
+        }
+        int split_demand = std::min(demand, instance.capacity - load);
+        node_index = solution.Insert(customer, split_demand, node_index, 0);
+        load += split_demand;
+        demand -= split_demand;
+      }
+    }
+    return solution;
+  }
 }  // namespace alkaidsd
@@ -1,12 +1,32 @@
 #pragma once
 
+#include <alkaidsd/config.h>
 #include <alkaidsd/instance.h>
 #include <alkaidsd/solution.h>
 
 #include <memory>
+#include <vector>
 
 #include "random.h"
 
 namespace alkaidsd {
   AlkaidSolution Construct(const Instance &instance, Random &random);
+
+  // Builds the initial solution of each restart with one of the configured methods, picked
+  // uniformly at random. The neighbor lists of the savings and the polar order of the sweep are
+  // computed once per instance.
+  class Constructor {
+  public:
+    Constructor(const Instance &instance, std::vector<ConstructionMethod> methods);
+    AlkaidSolution Construct(const Instance &instance, Random &random) const;
+
+  private:
+    AlkaidSolution Savings(const Instance &instance, Random &random) const;
+    AlkaidSolution Sweep(const Instance &instance, Random &random) const;
+
+    std::vector<ConstructionMethod> methods_;
+    Node num_neighbors_{};
+    std::vector<Node> neighbors_;
+    std::vector<Node> polar_order_;
+  };
 }  // namespace alkaidsd
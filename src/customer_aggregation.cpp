@@ -0,0 +1,101 @@
+#include "customer_aggregation.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace alkaidsd {
+  CustomerAggregation::CustomerAggregation(const Instance &instance) : instance_(instance) {
+    auto &&distance_matrix = instance.distance_matrix;
+    auto co_located = [&](Node i, Node j) {
+      for (Node k = 0; k < instance.num_customers; ++k) {
+        if (distance_matrix[i][k] != distance_matrix[j][k]
+            || distance_matrix[k][i] != distance_matrix[k][j]) {
+          return false;
+        }
+      }
+      return true;
+    };
+    // The customers in the same group have the same distances, so only the first customer of
+    // each group is compared.
+    std::vector<Node> groups(instance.num_customers);
+    std::vector<std::vector<Node>> members(1, std::vector<Node>(1, 0));
+    for (Node i = 1; i < instance.num_customers; ++i) {
+      groups[i] = 0;
+      for (Node j = 1; j < i && !groups[i]; ++j) {
+        if (distance_matrix[i][j] == 0 && distance_matrix[j][i] == 0
+            && members[groups[j]][0] == j && co_located(i, j)) {
+          groups[i] = groups[j];
+        }
+      }
+      if (groups[i]) {
+        members[groups[i]].push_back(i);
+      } else {
+        groups[i] = static_cast<Node>(members.size());
+        members.emplace_back(1, i);
+      }
+    }
+    if (members.size() == static_cast<size_t>(instance.num_customers)) {
+      return;
+    }
+    members_ = std::move(members);
+    reduced_.num_customers = static_cast<Node>(members_.size());
+    reduced_.capacity = instance.capacity;
+    reduced_.demands.assign(reduced_.num_customers, 0);
+    reduced_.distance_matrix.resize(reduced_.num_customers);
+    for (Node i = 0; i < reduced_.num_customers; ++i) {
+      for (Node member : members_[i]) {
+        reduced_.demands[i] += instance.demands[member];
+      }
+      auto &&distances = distance_matrix[members_[i][0]];
+      reduced_.distance_matrix[i].resize(reduced_.num_customers);
+      for (Node j = 0; j < reduced_.num_customers; ++j) {
+        reduced_.distance_matrix[i][j] = distances[members_[j][0]];
+      }
+    }
+  }
+
+  AlkaidSolution CustomerAggregation::Expand(const AlkaidSolution &solution) const {
+    AlkaidSolution expanded = solution;
+    if (members_.empty()) {
+      return expanded;
+    }
+    // The next member to serve of each merged customer and its remaining demand.
+    std::vector<size_t> positions(members_.size());
+    std::vector<int> remaining_demands(members_.size());
+    for (size_t i = 0; i < members_.size(); ++i) {
+      remaining_demands[i] = instance_.demands[members_[i][0]];
+    }
+    std::vector<Node> node_indices = expanded.NodeIndices();
+    for (Node node_index : node_indices) {
+      Node customer = expanded.Customer(node_index);
+      int load = expanded.Load(node_index);
+      auto &&members = members_[customer];
+      auto &position = positions[customer];
+      auto &remaining_demand = remaining_demands[customer];
+      // A node without load stays at the current member, which has the same distances.
+      expanded.SetCustomer(node_index, members[position]);
+      Node predecessor = 0;
+      while (load > 0) {
+        while (remaining_demand == 0 && position + 1 < members.size()) {
+          ++position;
+          remaining_demand = instance_.demands[members[position]];
+        }
+        if (remaining_demand == 0) {
+          throw std::logic_error("Loads exceed the demand of a merged customer.");
+        }
+        int split_load = std::min(load, remaining_demand);
+        if (predecessor == 0) {
+          expanded.SetCustomer(node_index, members[position]);
+          expanded.SetLoad(node_index, split_load);
+          predecessor = node_index;
+        } else {
+          predecessor = expanded.Insert(members[position], split_load, predecessor,
+                                        expanded.Successor(predecessor));
+        }
+        load -= split_load;
+        remaining_demand -= split_load;
+      }
+    }
+    return expanded;
+  }
+}  // namespace alkaidsd
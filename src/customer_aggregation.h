@@ -0,0 +1,29 @@
+#pragma once
+
+#include <alkaidsd/instance.h>
+#include <alkaidsd/solution.h>
+
+#include <vector>
+
+namespace alkaidsd {
+  // Merges the customers at zero distance from each other into one customer with their summed
+  // demand, so that the search scales with the number of distinct locations. Customers are only
+  // merged when their distances to all others are the same as well, so costs are preserved.
+  class CustomerAggregation {
+  public:
+    explicit CustomerAggregation(const Instance &instance);
+
+    // The instance to search, which is the original one when no customers are merged.
+    const Instance &Reduced() const { return members_.empty() ? instance_ : reduced_; }
+
+    // Maps a solution of the reduced instance back to the original customers. The load of a
+    // merged node is split over consecutive nodes of its members, which fill their demands in
+    // order across all the nodes of the merged customer.
+    AlkaidSolution Expand(const AlkaidSolution &solution) const;
+
+  private:
+    const Instance &instance_;
+    Instance reduced_;
+    std::vector<std::vector<Node>> members_;
+  };
+}  // namespace alkaidsd
@@ -0,0 +1,49 @@
+#include "direct_trips.h"
+
+namespace alkaidsd {
+  DirectTrips::DirectTrips(const Instance &instance) : instance_(instance) {
+    bool has_full_loads = false;
+    for (Node i = 1; i < instance.num_customers; ++i) {
+      int num_trips = instance.demands[i] / instance.capacity;
+      has_full_loads |= num_trips > 0;
+      cost_ += num_trips * (instance.distance_matrix[0][i] + instance.distance_matrix[i][0]);
+    }
+    if (!has_full_loads) {
+      return;
+    }
+    customers_.push_back(0);
+    for (Node i = 1; i < instance.num_customers; ++i) {
+      if (instance.demands[i] % instance.capacity > 0) {
+        customers_.push_back(i);
+      }
+    }
+    residual_.num_customers = static_cast<Node>(customers_.size());
+    residual_.capacity = instance.capacity;
+    residual_.demands.resize(residual_.num_customers);
+    residual_.distance_matrix.resize(residual_.num_customers);
+    for (Node i = 0; i < residual_.num_customers; ++i) {
+      residual_.demands[i] = instance.demands[customers_[i]] % instance.capacity;
+      auto &&distances = instance.distance_matrix[customers_[i]];
+      residual_.distance_matrix[i].resize(residual_.num_customers);
+      for (Node j = 0; j < residual_.num_customers; ++j) {
+        residual_.distance_matrix[i][j] = distances[customers_[j]];
+      }
+    }
+  }
+
+  AlkaidSolution DirectTrips::Expand(const AlkaidSolution &solution) const {
+    AlkaidSolution expanded = solution;
+    if (customers_.empty()) {
+      return expanded;
+    }
+    for (Node node_index : expanded.NodeIndices()) {
+      expanded.SetCustomer(node_index, customers_[expanded.Customer(node_index)]);
+    }
+    for (Node i = 1; i < instance_.num_customers; ++i) {
+      for (int j = 0; j < instance_.demands[i] / instance_.capacity; ++j) {
+        expanded.Insert(i, instance_.capacity, 0, 0);
+      }
+    }
+    return expanded;
+  }
+}  // namespace alkaidsd
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <alkaidsd/instance.h>
+#include <alkaidsd/solution.h>
+
+#include <vector>
+
+namespace alkaidsd {
+  // Serves every full capacity of a demand by a direct trip fixed before the search. Some optimal
+  // solution contains these trips, so the search only runs on the residual instance of the
+  // customers with a remaining demand.
+  class DirectTrips {
+  public:
+    explicit DirectTrips(const Instance &instance);
+
+    // The instance to search, which is the original one when there is no full capacity.
+    const Instance &Residual() const { return customers_.empty() ? instance_ : residual_; }
+
+    // The total length of the direct trips.
+    int Cost() const { return cost_; }
+
+    // Maps a solution of the residual instance back to the original customers and adds the
+    // direct trips.
+    AlkaidSolution Expand(const AlkaidSolution &solution) const;
+
+  private:
+    const Instance &instance_;
+    Instance residual_;
+    std::vector<Node> customers_;
+    int cost_{};
+  };
+}  // namespace alkaidsd
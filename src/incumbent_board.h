@@ -0,0 +1,50 @@
+#pragma once
+
+#include <alkaidsd/solution.h>
+
+#include <atomic>
+#include <limits>
+#include <mutex>
+
+namespace alkaidsd {
+  // The best solution published by concurrent restart loops. The best objective is atomic, so
+  // that loops reject a solution that does not improve it without locking. Only improvements,
+  // which are rare, copy the solution under the lock.
+  class IncumbentBoard {
+  public:
+    void Publish(const AlkaidSolution &solution, int objective) {
+      if (objective >= objective_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (objective < objective_.load(std::memory_order_relaxed)) {
+        solution_ = solution;
+        objective_.store(objective, std::memory_order_relaxed);
+        updated_.store(true, std::memory_order_relaxed);
+      }
+    }
+
+    // Calls func with the best solution and objective if they changed since the last call. Only
+    // one thread should call it, so that func is never called concurrently.
+    template <class Func> void Notify(const Func &func) {
+      if (!updated_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      AlkaidSolution solution;
+      int objective;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        updated_.store(false, std::memory_order_relaxed);
+        solution = solution_;
+        objective = objective_.load(std::memory_order_relaxed);
+      }
+      func(solution, objective);
+    }
+
+  private:
+    std::mutex mutex_;
+    AlkaidSolution solution_;
+    std::atomic<int> objective_{std::numeric_limits<int>::max()};
+    std::atomic<bool> updated_{};
+  };
+}  // namespace alkaidsd
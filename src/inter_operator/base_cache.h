@@ -1,6 +1,11 @@
 #pragma once
 
-#include <algorithm>
+#include <alkaidsd/inter_operator.h>
+#include <alkaidsd/statistics.h>
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include "../cache.h"
@@ -9,81 +14,200 @@
 
 namespace alkaidsd::inter_operator {
   template <class T> struct BaseCache {
-    bool invalidated = true;
+    uint64_t version = 0;
     Delta<int> delta;
     T move;
+    int num_evaluations = 0;
 
-    bool TryReuse() {
-      if (!invalidated) {
+    bool TryReuse(uint64_t current_version, OperatorStatistics *statistics) {
+      if (version == current_version) {
+        if (statistics) {
+          ++statistics->num_cache_hits;
+        }
         return true;
       }
-      invalidated = false;
+      if (statistics) {
+        ++statistics->num_cache_misses;
+        statistics->num_cache_invalidations += version != 0;
+      }
+      version = current_version;
       delta = Delta<int>();
+      num_evaluations = 0;
       return false;
     }
+
+    bool Update(int value, Random &random) {
+      ++num_evaluations;
+      return delta.Update(value, random);
+    }
   };
 
+  // Pair caches are indexed by route slot. Every slot carries a version that is bumped whenever
+  // its route changes, and a pair cache is valid only while it matches the versions of both of
+  // its routes, so a route change costs O(1) whatever the fleet size.
   template <class T> class InterRouteCache : public Cache {
   public:
     void Reset([[maybe_unused]] const AlkaidSolution &solution, const RouteContext &context) override {
-      max_index_ = context.NumRoutes();
-      matrix_.resize(context.NumRoutes());
-      route_index_mappings_.resize(context.NumRoutes());
-      route_pool_.clear();
-      unused_indices_.clear();
-      for (Node i = 0; i < context.NumRoutes(); ++i) {
-        matrix_[i].resize(context.NumRoutes());
-        route_index_mappings_[i] = i;
-        route_pool_.emplace_back(i);
-        for (Node j = 0; j < context.NumRoutes(); ++j) {
-          matrix_[i][j].invalidated = true;
-        }
+      Grow(context.NumRoutes());
+      for (auto &version : versions_) {
+        ++version;
       }
     }
 
     void AddRoute(Node route_index) override {
-      Node index;
-      if (unused_indices_.empty()) {
-        index = max_index_++;
-        route_index_mappings_.resize(max_index_);
-        matrix_.resize(max_index_);
-        for (Node i = 0; i < max_index_; ++i) {
-          matrix_[i].resize(max_index_);
-        }
-      } else {
-        index = unused_indices_.back();
-        unused_indices_.pop_back();
-      }
-      route_index_mappings_[route_index] = index;
-      route_pool_.emplace_back(index);
-      for (Node other : route_pool_) {
-        matrix_[index][other].invalidated = true;
-        matrix_[other][index].invalidated = true;
-      }
+      Grow(route_index + 1);
+      ++versions_[route_index];
     }
 
-    void RemoveRoute(Node route_index) override {
-      Node index = route_index_mappings_[route_index];
-      route_pool_.erase(std::find(route_pool_.begin(), route_pool_.end(), index));
-      unused_indices_.emplace_back(index);
-    }
-
-    void MoveRoute(Node dest_route_index, Node src_route_index) override {
-      route_index_mappings_[dest_route_index] = route_index_mappings_[src_route_index];
-    }
+    void RemoveRoute(Node route_index) override { ++versions_[route_index]; }
 
     void Save([[maybe_unused]] const AlkaidSolution &solution,
               [[maybe_unused]] const RouteContext &context) override {}
 
-    BaseCache<T> &Get(Node route_a, Node route_b) {
-      return matrix_[route_index_mappings_[route_a]][route_index_mappings_[route_b]];
+    BaseCache<T> &Get(Node route_a, Node route_b) { return matrix_[route_a][route_b]; }
+
+    uint64_t Version(Node route_a, Node route_b) const {
+      return static_cast<uint64_t>(versions_[route_a]) << 32 | versions_[route_b];
     }
 
   private:
+    void Grow(Node num_routes) {
+      if (versions_.size() >= static_cast<size_t>(num_routes)) {
+        return;
+      }
+      versions_.resize(num_routes);
+      matrix_.resize(num_routes);
+      for (auto &row : matrix_) {
+        row.resize(num_routes);
+      }
+    }
+
     std::vector<std::vector<BaseCache<T>>> matrix_;
-    std::vector<Node> route_index_mappings_;
-    std::vector<Node> route_pool_;
-    std::vector<Node> unused_indices_;
-    Node max_index_{};
+    std::vector<uint32_t> versions_;
   };
+
+  // Scans the pairs of active routes (each unordered pair once, from its smaller slot, when the
+  // operator is symmetric), evaluating the pairs whose cache is outdated, and returns the best
+  // delta together with its move. Outdated pairs rejected by the filter get an empty cache, which
+  // stays valid until one of their routes changes. First improvement shuffles the routes and stops
+  // at the first improving pair; sampling skips each outdated pair with probability
+  // 1 - sample_rate and leaves its cache outdated.
+  //
+  // The filter runs serially, under the mutex of the cache map, and is the place to build lazy
+  // per-route data. The evaluations run on the thread pool of the cache map and must only read
+  // shared state; each gets a generator seeded by its position in the scan, and the results are
+  // merged in scan order, so the outcome does not depend on the number of threads. First
+  // improvement evaluates kFirstImprovementBatch outdated pairs at a time and keeps no result past
+  // the first improving pair.
+  //
+  // The pair caches are kept per move type and cache_key, so that variants of an operator that
+  // search different neighborhoods, such as granular ones, never reuse each other's moves.
+  constexpr int kFirstImprovementBatch = 16;
+
+  // The filter that keeps every route pair.
+  constexpr auto kAllRoutePairs = [](Node, Node) { return true; };
+
+  template <class T, class Filter, class Evaluate>
+  Delta<int> FindBestMove(const AlkaidSolution &solution, const RouteContext &context,
+                          CacheMap &cache_map, const ScanPolicy &scan_policy, bool symmetric,
+                          Random &random, const Filter &filter, const Evaluate &evaluate,
+                          T &best_move, int cache_key = 0) {
+    struct Task {
+      Node route_x, route_y;
+      uint64_t version;
+      int result;  // The index of the evaluation in results, or -1.
+    };
+    auto statistics = cache_map.Statistics();
+    auto &caches = cache_map.Get<InterRouteCache<T>>(solution, context, cache_key);
+    std::unique_lock<std::mutex> lock(cache_map.Mutex());
+    const std::vector<Node> *routes = &context.ActiveRoutes();
+    std::vector<Node> shuffled_routes;
+    bool first_improvement = scan_policy.strategy == kFirstImprovement;
+    if (first_improvement) {
+      shuffled_routes = *routes;
+      random.Shuffle(shuffled_routes.begin(), shuffled_routes.end());
+      routes = &shuffled_routes;
+    }
+    uint32_t seed = random.NextSeed();
+    uint32_t num_results = 0;
+    std::vector<Task> tasks;
+    std::vector<int> pending;
+    std::vector<BaseCache<T>> results;
+    Delta<int> best_delta{};
+    // Evaluates the pending tasks and merges them in order. Returns whether the scan is over.
+    auto flush = [&]() {
+      results.assign(pending.size(), BaseCache<T>());
+      lock.unlock();
+      cache_map.ParallelFor(static_cast<int>(pending.size()), [&](int k) {
+        auto &task = tasks[pending[k]];
+        Random pair_random(seed + num_results + k);
+        evaluate(task.route_x, task.route_y, results[k], pair_random);
+      });
+      lock.lock();
+      num_results += static_cast<uint32_t>(pending.size());
+      for (auto &task : tasks) {
+        auto &cache = caches.Get(task.route_x, task.route_y);
+        if (!cache.TryReuse(task.version, statistics)) {
+          if (task.result != -1) {
+            cache = results[task.result];
+            cache.version = task.version;
+            if (statistics) {
+              statistics->num_evaluations += cache.num_evaluations;
+            }
+          } else if (statistics) {
+            ++statistics->num_filtered_pairs;
+          }
+        }
+        if (best_delta.Update(cache.delta, random)) {
+          best_move = cache.move;
+          if (first_improvement && best_delta.value < 0) {
+            return true;
+          }
+        }
+      }
+      tasks.clear();
+      pending.clear();
+      return false;
+    };
+    for (size_t i = 0; i < routes->size(); ++i) {
+      for (size_t j = symmetric ? i + 1 : 0; j < routes->size(); ++j) {
+        if (i == j) {
+          continue;
+        }
+        Node route_x = (*routes)[i];
+        Node route_y = (*routes)[j];
+        if (symmetric && route_x > route_y) {
+          std::swap(route_x, route_y);
+        }
+        auto &cache = caches.Get(route_x, route_y);
+        uint64_t version = caches.Version(route_x, route_y);
+        bool outdated = cache.version != version;
+        if (scan_policy.strategy == kSampledImprovement && outdated
+            && random.NextFloat() >= scan_policy.sample_rate) {
+          continue;
+        }
+        tasks.push_back({route_x, route_y, version, -1});
+        if (outdated && filter(route_x, route_y)) {
+          tasks.back().result = static_cast<int>(pending.size());
+          pending.push_back(static_cast<int>(tasks.size()) - 1);
+        }
+        if (first_improvement
+            && (static_cast<int>(pending.size()) >= kFirstImprovementBatch
+                || (!outdated && cache.delta.value < 0))
+            && flush()) {
+          return best_delta;
+        }
+      }
+    }
+    flush();
+    return best_delta;
+  }
+
+  template <class T, class Evaluate>
+  Delta<int> FindBestMove(const AlkaidSolution &solution, const RouteContext &context,
+                          CacheMap &cache_map, const ScanPolicy &scan_policy, bool symmetric,
+                          Random &random, const Evaluate &evaluate, T &best_move) {
+    return FindBestMove(solution, context, cache_map, scan_policy, symmetric, random,
+                        kAllRoutePairs, evaluate, best_move);
+  }
 }  // namespace alkaidsd::inter_operator
@@ -61,60 +61,155 @@ namespace alkaidsd::inter_operator {
     }
   };
 
+  struct StarEdge {
+    Node predecessor, successor;
+    Node predecessor_customer, successor_customer;
+  };
+
+  struct StarCache {
+    std::vector<BestInsertion<3>> insertions;
+    std::vector<StarEdge> edges;
+    bool outdated = false;
+  };
+
+  struct StarWorkspace {
+    std::vector<StarEdge> edges;
+    std::vector<int> node_stamps;
+    std::vector<int> edge_stamps;
+    std::vector<Node> depleted;
+    int num_kept{};
+    int stamp{};
+  };
+
   class StarCaches : public Cache {
   public:
-    void Reset(const AlkaidSolution &solution, const RouteContext &context) override {
+    void Reset([[maybe_unused]] const AlkaidSolution &solution,
+               const RouteContext &context) override {
+      retired_.clear();
+      free_retired_.clear();
+      for (auto &cache : caches_) {
+        Retire(cache);
+      }
       caches_.resize(context.NumRoutes());
-      for (Node route_index = 0;
-           static_cast<size_t>(route_index) < std::min(routes_.size(), caches_.size());
-           ++route_index) {
-        bool same_route = false;
-        if (route_index < context.NumRoutes()) {
-          same_route = true;
-          Node head = context.Head(route_index);
-          for (Node node : routes_[route_index]) {
-            if (head != node) {
-              same_route = false;
-              break;
-            }
-            head = solution.Successor(head);
-          }
-          if (head != 0) {
-            same_route = false;
-          }
+    }
+    void AddRoute(Node route_index) override {
+      if (caches_.size() <= static_cast<size_t>(route_index)) {
+        caches_.resize(route_index + 1);
+      }
+    }
+    void RemoveRoute(Node route_index) override { Retire(caches_[route_index]); }
+    void Save([[maybe_unused]] const AlkaidSolution &solution,
+              [[maybe_unused]] const RouteContext &context) override {}
+    void Warmup(const Instance &instance, const AlkaidSolution &solution,
+                const RouteContext &context, Random &random, ThreadPool &thread_pool) override {
+      std::vector<Node> routes;
+      for (Node route_index : context.ActiveRoutes()) {
+        if (Adopt(solution, context, route_index)) {
+          routes.push_back(route_index);
         }
-        if (!same_route) {
-          caches_[route_index].clear();
+      }
+      uint32_t seed = random.NextSeed();
+      thread_pool.ParallelFor(static_cast<int>(routes.size()), [&](int i) {
+        // One workspace per pool thread, so that its stamps are only allocated once.
+        thread_local StarWorkspace workspace;
+        Random route_random(seed + routes[i]);
+        Update(instance, solution, context, routes[i], workspace, route_random);
+      });
+    }
+    // Counts the preprocess in statistics, which belong to the calling operator. Called under the
+    // mutex of the cache map when operators run concurrently.
+    void Preprocess(const Instance &problem, const AlkaidSolution &solution, const RouteContext &context,
+                    Node route, Random &random, OperatorStatistics *statistics) {
+      if (Adopt(solution, context, route)) {
+        if (statistics) {
+          ++statistics->num_preprocesses;
         }
+        Update(problem, solution, context, route, workspace_, random);
       }
     }
-    void AddRoute(Node route_index) override { caches_.resize(route_index + 1); }
-    void RemoveRoute(Node route_index) override { caches_[route_index].clear(); }
-    void MoveRoute(Node dest_route_index, Node src_route_index) override {
-      caches_[dest_route_index].swap(caches_[src_route_index]);
+    BestInsertion<3> &Get(Node route_index, Node customer) {
+      return caches_[route_index].insertions[customer];
     }
-    void Preprocess(const Instance &problem, const AlkaidSolution &solution, const RouteContext &context,
-                    Node route, Random &random) {
-      auto &&insertions = caches_[route];
-      if (!insertions.empty()) {
+
+  private:
+    void Retire(StarCache &cache) {
+      if (cache.insertions.empty()) {
         return;
       }
-      insertions.resize(problem.num_customers);
-      for (Node customer = 1; customer < problem.num_customers; ++customer) {
-        insertions[customer].Reset();
+      if (free_retired_.empty()) {
+        if (retired_.size() > 2 * caches_.size() + 2) {
+          cache.insertions.clear();
+          return;
+        }
+        free_retired_.push_back(static_cast<int>(retired_.size()));
+        retired_.emplace_back();
+      }
+      int index = free_retired_.back();
+      free_retired_.pop_back();
+      std::swap(retired_[index], cache);
+      cache.insertions.clear();
+      for (const auto &edge : retired_[index].edges) {
+        if (static_cast<size_t>(edge.predecessor) >= owners_.size()) {
+          owners_.resize(edge.predecessor + 1, -1);
+        }
+        owners_[edge.predecessor] = index;
+      }
+    }
+
+    // Returns whether the route needs an Update. If a retired cache shares most edges with the
+    // route, it is moved into the route's slot as the base of an incremental update.
+    bool Adopt(const AlkaidSolution &solution, const RouteContext &context, Node route) {
+      auto &cache = caches_[route];
+      if (!cache.insertions.empty()) {
+        return cache.outdated;
+      }
+      CollectEdges(solution, context, route, workspace_);
+      owners_.resize(solution.MaxNodeIndex() + 1, -1);
+      int base = -1;
+      int max_votes = 0;
+      votes_.assign(retired_.size(), 0);
+      for (const auto &edge : workspace_.edges) {
+        int owner = owners_[edge.predecessor];
+        if (edge.predecessor && owner != -1 && static_cast<size_t>(owner) < retired_.size()
+            && !retired_[owner].insertions.empty() && ++votes_[owner] > max_votes) {
+          max_votes = votes_[owner];
+          base = owner;
+        }
+      }
+      if (base != -1 && IsWorthUpdating(solution, context, route, retired_[base], workspace_)) {
+        std::swap(cache, retired_[base]);
+        retired_[base].insertions.clear();
+        free_retired_.push_back(base);
+        cache.outdated = true;
+      }
+      return true;
+    }
+
+    void Update(const Instance &problem, const AlkaidSolution &solution, const RouteContext &context,
+                Node route, StarWorkspace &workspace, Random &random) {
+      auto &cache = caches_[route];
+      CollectEdges(solution, context, route, workspace);
+      if (cache.outdated && IsWorthUpdating(solution, context, route, cache, workspace)) {
+        IncrementalPreprocess(problem, cache, workspace, random);
+      } else {
+        FullPreprocess(problem, cache, workspace, random);
       }
+      cache.edges.assign(workspace.edges.begin(), workspace.edges.end());
+      cache.outdated = false;
+    }
+
+    static void CollectEdges(const AlkaidSolution &solution, const RouteContext &context,
+                             Node route, StarWorkspace &workspace) {
+      ++workspace.stamp;
+      workspace.node_stamps.resize(solution.MaxNodeIndex() + 1);
+      workspace.edge_stamps.resize(solution.MaxNodeIndex() + 1);
+      workspace.edges.clear();
       Node predecessor = 0;
       Node successor = context.Head(route);
       while (true) {
-        Node predecessor_customer = solution.Customer(predecessor);
-        Node successor_customer = solution.Customer(successor);
-        auto &&predecessor_distances = problem.distance_matrix[predecessor_customer];
-        auto &&successor_distances = problem.distance_matrix[successor_customer];
-        auto distance = problem.distance_matrix[predecessor_customer][successor_customer];
-        for (Node customer = 1; customer < problem.num_customers; ++customer) {
-          int delta = predecessor_distances[customer] + successor_distances[customer] - distance;
-          insertions[customer].Add(delta, predecessor, successor, random);
-        }
+        workspace.node_stamps[predecessor] = workspace.stamp;
+        workspace.edges.push_back({predecessor, successor, solution.Customer(predecessor),
+                                   solution.Customer(successor)});
         if (!successor) {
           break;
         }
@@ -122,23 +217,95 @@ namespace alkaidsd::inter_operator {
         successor = solution.Successor(successor);
       }
     }
-    void Save(const AlkaidSolution &solution, const RouteContext &context) override {
-      routes_.resize(context.NumRoutes());
-      for (Node route_index = 0; static_cast<size_t>(route_index) < routes_.size(); ++route_index) {
-        auto &route = routes_[route_index];
-        route.clear();
-        for (Node node = context.Head(route_index); node; node = solution.Successor(node)) {
-          route.push_back(node);
+
+    // Marks the edges of base that survive in the route, and tells whether enough of them do. The
+    // base may come from an earlier solution with more nodes.
+    static bool IsWorthUpdating(const AlkaidSolution &solution, const RouteContext &context,
+                                Node route, const StarCache &base, StarWorkspace &workspace) {
+      int num_kept = 0;
+      for (const auto &edge : base.edges) {
+        bool kept = edge.predecessor
+                        ? static_cast<size_t>(edge.predecessor) < workspace.node_stamps.size()
+                              && workspace.node_stamps[edge.predecessor] == workspace.stamp
+                              && solution.Successor(edge.predecessor) == edge.successor
+                        : context.Head(route) == edge.successor;
+        if (kept && solution.Customer(edge.predecessor) == edge.predecessor_customer
+            && solution.Customer(edge.successor) == edge.successor_customer) {
+          workspace.edge_stamps[edge.predecessor] = workspace.stamp;
+          ++num_kept;
         }
       }
+      workspace.num_kept = num_kept;
+      return 2 * num_kept >= static_cast<int>(workspace.edges.size());
     }
-    BestInsertion<3> &Get(Node route_index, Node customer) {
-      return caches_[route_index][customer];
+
+    static void FullPreprocess(const Instance &problem, StarCache &cache,
+                               const StarWorkspace &workspace, Random &random) {
+      cache.insertions.resize(problem.num_customers);
+      for (Node customer = 1; customer < problem.num_customers; ++customer) {
+        cache.insertions[customer].Reset();
+      }
+      for (const auto &edge : workspace.edges) {
+        auto &&predecessor_distances = problem.distance_matrix[edge.predecessor_customer];
+        auto &&successor_distances = problem.distance_matrix[edge.successor_customer];
+        auto distance = predecessor_distances[edge.successor_customer];
+        for (Node customer = 1; customer < problem.num_customers; ++customer) {
+          int delta = predecessor_distances[customer] + successor_distances[customer] - distance;
+          cache.insertions[customer].Add(delta, edge.predecessor, edge.successor, random);
+        }
+      }
     }
 
-  private:
-    std::vector<std::vector<BestInsertion<3>>> caches_;
-    std::vector<std::vector<Node>> routes_;
+    // Customers that lost one of their top-3 insertions are rescanned over the whole route, the
+    // others only need the edges that were not in the base route. So each added edge costs O(N),
+    // each depleted customer O(L), and a route that lost no edge has no depleted customer.
+    static void IncrementalPreprocess(const Instance &problem, StarCache &cache,
+                                      StarWorkspace &workspace, Random &random) {
+      workspace.depleted.clear();
+      if (workspace.num_kept < static_cast<int>(cache.edges.size())) {
+        for (Node customer = 1; customer < problem.num_customers; ++customer) {
+          for (const auto &insertion : cache.insertions[customer].insertions) {
+            if (insertion.delta.counter != -1
+                && (static_cast<size_t>(insertion.predecessor) >= workspace.edge_stamps.size()
+                    || workspace.edge_stamps[insertion.predecessor] != workspace.stamp)) {
+              workspace.depleted.push_back(customer);
+              cache.insertions[customer].Reset();
+              break;
+            }
+          }
+        }
+      }
+      for (const auto &edge : workspace.edges) {
+        if (workspace.edge_stamps[edge.predecessor] == workspace.stamp) {
+          continue;
+        }
+        auto &&predecessor_distances = problem.distance_matrix[edge.predecessor_customer];
+        auto &&successor_distances = problem.distance_matrix[edge.successor_customer];
+        auto distance = predecessor_distances[edge.successor_customer];
+        for (Node customer = 1; customer < problem.num_customers; ++customer) {
+          int delta = predecessor_distances[customer] + successor_distances[customer] - distance;
+          cache.insertions[customer].Add(delta, edge.predecessor, edge.successor, random);
+        }
+      }
+      auto &&distance_matrix = problem.distance_matrix;
+      for (Node customer : workspace.depleted) {
+        for (const auto &edge : workspace.edges) {
+          if (workspace.edge_stamps[edge.predecessor] == workspace.stamp) {
+            int delta = distance_matrix[edge.predecessor_customer][customer]
+                        + distance_matrix[edge.successor_customer][customer]
+                        - distance_matrix[edge.predecessor_customer][edge.successor_customer];
+            cache.insertions[customer].Add(delta, edge.predecessor, edge.successor, random);
+          }
+        }
+      }
+    }
+
+    std::vector<StarCache> caches_;
+    std::vector<StarCache> retired_;
+    std::vector<int> free_retired_;
+    std::vector<int> owners_;
+    std::vector<int> votes_;
+    StarWorkspace workspace_;
   };
 
   inline int CalcDelta(const Instance &problem, const AlkaidSolution &solution, Node node_index,
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <alkaidsd/inter_operator.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "../cache.h"
+
+namespace alkaidsd::inter_operator {
+  // Bounding circles of the routes in the metric of the distance matrix. The center is the route
+  // customer with the smallest eccentricity and the radius is that eccentricity. Two routes whose
+  // circles are disjoint are too far apart to exchange customers profitably. Circles are rebuilt
+  // lazily after their route changes.
+  class BoundingCircles : public Cache {
+  public:
+    void Reset([[maybe_unused]] const AlkaidSolution &solution,
+               const RouteContext &context) override {
+      circles_.assign(context.NumRoutes(), Circle{});
+    }
+    void AddRoute(Node route_index) override {
+      if (circles_.size() <= static_cast<size_t>(route_index)) {
+        circles_.resize(route_index + 1);
+      }
+      circles_[route_index].outdated = true;
+    }
+    void RemoveRoute(Node route_index) override { circles_[route_index].outdated = true; }
+    void Save([[maybe_unused]] const AlkaidSolution &solution,
+              [[maybe_unused]] const RouteContext &context) override {}
+
+    bool Overlap(const Instance &instance, const AlkaidSolution &solution,
+                 const RouteContext &context, Node route_a, Node route_b) {
+      auto &circle_a = Get(instance, solution, context, route_a);
+      auto &circle_b = Get(instance, solution, context, route_b);
+      return instance.distance_matrix[circle_a.center][circle_b.center]
+             <= circle_a.radius + circle_b.radius;
+    }
+
+  private:
+    struct Circle {
+      Node center{};
+      int radius{};
+      bool outdated = true;
+    };
+
+    const Circle &Get(const Instance &instance, const AlkaidSolution &solution,
+                      const RouteContext &context, Node route_index) {
+      auto &circle = circles_[route_index];
+      if (!circle.outdated) {
+        return circle;
+      }
+      customers_.clear();
+      for (Node node_index = context.Head(route_index); node_index;
+           node_index = solution.Successor(node_index)) {
+        customers_.emplace_back(solution.Customer(node_index));
+      }
+      circle.radius = std::numeric_limits<int>::max();
+      for (Node center : customers_) {
+        int radius = 0;
+        for (Node customer : customers_) {
+          radius = std::max(radius, instance.distance_matrix[center][customer]);
+        }
+        if (radius < circle.radius) {
+          circle.center = center;
+          circle.radius = radius;
+        }
+      }
+      circle.outdated = false;
+      return circle;
+    }
+
+    std::vector<Circle> circles_;
+    std::vector<Node> customers_;
+  };
+}  // namespace alkaidsd::inter_operator
@@ -1,6 +1,8 @@
 #include <alkaidsd/inter_operator.h>
 
 #include "base_cache.h"
+#include "bounding_circle.h"
+#include "granular.h"
 
 namespace alkaidsd::inter_operator {
   struct CrossMove {
@@ -41,40 +43,74 @@ namespace alkaidsd::inter_operator {
     }
   }
 
+  void UpdateCross(const Instance &instance, const AlkaidSolution &solution,
+                   const RouteContext &context, Node route_x, Node route_y, Node left_x,
+                   Node left_y, BaseCache<CrossMove> &cache, Random &random) {
+    Node successor_x = left_x ? solution.Successor(left_x) : context.Head(route_x);
+    Node predecessor_y = left_y;
+    Node successor_y = left_y ? solution.Successor(left_y) : context.Head(route_y);
+    int predecessor_load_x = context.PreLoad(left_x);
+    int successor_load_x = context.Load(route_x) - predecessor_load_x;
+    int predecessor_load_y = context.PreLoad(left_y);
+    int successor_load_y = context.Load(route_y) - predecessor_load_y;
+    int base
+        = -instance.distance_matrix[solution.Customer(left_x)][solution.Customer(successor_x)]
+          - instance.distance_matrix[solution.Customer(left_y)][solution.Customer(successor_y)];
+    for (bool reversed : {false, true}) {
+      if (predecessor_load_x + successor_load_y <= instance.capacity
+          && successor_load_x + predecessor_load_y <= instance.capacity) {
+        int delta
+            = base
+              + instance.distance_matrix[solution.Customer(left_x)][solution.Customer(successor_y)]
+              + instance.distance_matrix[solution.Customer(successor_x)]
+                                        [solution.Customer(predecessor_y)];
+        if (cache.Update(delta, random)) {
+          cache.move = {reversed, route_x, route_y, left_x, left_y};
+        }
+      }
+      std::swap(predecessor_y, successor_y);
+      std::swap(predecessor_load_y, successor_load_y);
+    }
+  }
+
   void CrossInner(const Instance &instance, const AlkaidSolution &solution, const RouteContext &context,
                   Node route_x, Node route_y, BaseCache<CrossMove> &cache, Random &random) {
     Node left_x = 0;
     do {
-      Node successor_x = left_x ? solution.Successor(left_x) : context.Head(route_x);
       Node left_y = 0;
       do {
-        Node predecessor_y = left_y;
-        Node successor_y = left_y ? solution.Successor(left_y) : context.Head(route_y);
-        int predecessor_load_x = context.PreLoad(left_x);
-        int successor_load_x = context.Load(route_x) - predecessor_load_x;
-        int predecessor_load_y = context.PreLoad(left_y);
-        int successor_load_y = context.Load(route_y) - predecessor_load_y;
-        int base
-            = -instance.distance_matrix[solution.Customer(left_x)][solution.Customer(successor_x)]
-              - instance.distance_matrix[solution.Customer(left_y)][solution.Customer(successor_y)];
-        for (bool reversed : {false, true}) {
-          if (predecessor_load_x + successor_load_y <= instance.capacity
-              && successor_load_x + predecessor_load_y <= instance.capacity) {
-            int delta
-                = base
-                  + instance
-                        .distance_matrix[solution.Customer(left_x)][solution.Customer(successor_y)]
-                  + instance.distance_matrix[solution.Customer(successor_x)]
-                                           [solution.Customer(predecessor_y)];
-            if (cache.delta.Update(delta, random)) {
-              cache.move = {reversed, route_x, route_y, left_x, left_y};
-            }
-          }
-          std::swap(predecessor_y, successor_y);
-          std::swap(predecessor_load_y, successor_load_y);
-        }
-        left_y = successor_y;
+        UpdateCross(instance, solution, context, route_x, route_y, left_x, left_y, cache, random);
+        left_y = left_y ? solution.Successor(left_y) : context.Head(route_y);
       } while (left_y);
+      left_x = left_x ? solution.Successor(left_x) : context.Head(route_x);
+    } while (left_x);
+  }
+
+  // A cross move creates the edges (left_x, y) and (successor_x, y') where y and y' are left_y and
+  // its successor in either order, so it suffices to try left_y on and before every neighbor.
+  void GranularCrossInner(const Instance &instance, const AlkaidSolution &solution,
+                          const RouteContext &context, Node route_x, Node route_y,
+                          BaseCache<CrossMove> &cache, const GranularNeighbors::List &neighbors,
+                          Random &random) {
+    auto &locator = GranularNeighbors::Locator(0);
+    locator.Mark(solution, context.Head(route_y), instance.num_customers);
+    Node left_x = 0;
+    do {
+      Node successor_x = left_x ? solution.Successor(left_x) : context.Head(route_x);
+      for (Node node_x : {left_x, successor_x}) {
+        if (!node_x) {
+          continue;
+        }
+        neighbors.ForEach(solution.Customer(node_x), [&](Node customer) {
+          Node node_y = locator.Find(customer);
+          if (node_y) {
+            UpdateCross(instance, solution, context, route_x, route_y, left_x, node_y, cache,
+                        random);
+            UpdateCross(instance, solution, context, route_x, route_y, left_x,
+                        solution.Predecessor(node_y), cache, random);
+          }
+        });
+      }
       left_x = successor_x;
     } while (left_x);
   }
@@ -82,22 +118,31 @@ namespace alkaidsd::inter_operator {
   std::vector<Node> inter_operator::Cross::operator()(const Instance &instance, AlkaidSolution &solution,
                                                       RouteContext &context, Random &random,
                                                       CacheMap &cache_map) const {
-    auto &caches = cache_map.Get<InterRouteCache<CrossMove>>(solution, context);
+    // The circles are only kept up to date when they filter the route pairs.
+    auto circles
+        = filter_route_pairs_ ? &cache_map.Get<BoundingCircles>(solution, context) : nullptr;
+    auto filter = [&](Node route_x, Node route_y) {
+      return !circles || circles->Overlap(instance, solution, context, route_x, route_y);
+    };
     CrossMove best_move{};
-    Delta<int> best_delta{};
-    for (Node route_x = 0; route_x < context.NumRoutes(); ++route_x) {
-      for (Node route_y = route_x + 1; route_y < context.NumRoutes(); ++route_y) {
-        auto &cache = caches.Get(route_x, route_y);
-        if (!cache.TryReuse()) {
-          CrossInner(instance, solution, context, route_x, route_y, cache, random);
-        } else {
-          cache.move.route_x = route_x;
-          cache.move.route_y = route_y;
-        }
-        if (best_delta.Update(cache.delta, random)) {
-          best_move = cache.move;
-        }
-      }
+    Delta<int> best_delta;
+    if (num_neighbors_) {
+      auto &neighbors
+          = cache_map.Get<GranularNeighbors>(solution, context).Build(instance, num_neighbors_);
+      best_delta = FindBestMove(
+          solution, context, cache_map, scan_policy_, true, random, filter,
+          [&](Node route_x, Node route_y, BaseCache<CrossMove> &cache, Random &pair_random) {
+            GranularCrossInner(instance, solution, context, route_x, route_y, cache, neighbors,
+                               pair_random);
+          },
+          best_move, num_neighbors_);
+    } else {
+      best_delta = FindBestMove(
+          solution, context, cache_map, scan_policy_, true, random, filter,
+          [&](Node route_x, Node route_y, BaseCache<CrossMove> &cache, Random &pair_random) {
+            CrossInner(instance, solution, context, route_x, route_y, cache, pair_random);
+          },
+          best_move);
     }
     if (best_delta.value < 0) {
       DoCross(best_move, solution, context);
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <alkaidsd/inter_operator.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "../cache.h"
+
+namespace alkaidsd::inter_operator {
+  // Finds the node serving a customer in the route marked last.
+  class RouteLocator {
+  public:
+    void Mark(const AlkaidSolution &solution, Node head, Node num_customers) {
+      if (stamps_.size() < static_cast<size_t>(num_customers)) {
+        stamps_.resize(num_customers);
+        nodes_.resize(num_customers);
+      }
+      ++stamp_;
+      for (Node node_index = head; node_index; node_index = solution.Successor(node_index)) {
+        Node customer = solution.Customer(node_index);
+        stamps_[customer] = stamp_;
+        nodes_[customer] = node_index;
+      }
+    }
+
+    Node Find(Node customer) const { return stamps_[customer] == stamp_ ? nodes_[customer] : 0; }
+
+  private:
+    std::vector<int> stamps_;
+    std::vector<Node> nodes_;
+    int stamp_{};
+  };
+
+  // The nearest customers of every customer, depot excluded, built from the distance matrix once
+  // per instance and number of neighbors. Granular operators only evaluate moves that create an
+  // edge between a customer and one of its first num_neighbors neighbors. A built list is never
+  // modified, so that operators with different numbers of neighbors can read their lists while
+  // another one is built.
+  class GranularNeighbors : public Cache {
+  public:
+    class List {
+    public:
+      template <class Func> void ForEach(Node customer, const Func &func) const {
+        auto begin = neighbors_.begin() + static_cast<size_t>(customer) * num_neighbors_;
+        for (auto it = begin; it != begin + num_neighbors_; ++it) {
+          func(*it);
+        }
+      }
+
+    private:
+      friend class GranularNeighbors;
+      Node num_neighbors_{};
+      std::vector<Node> neighbors_;
+    };
+
+    void Reset([[maybe_unused]] const AlkaidSolution &solution,
+               [[maybe_unused]] const RouteContext &context) override {}
+    void AddRoute([[maybe_unused]] Node route_index) override {}
+    void RemoveRoute([[maybe_unused]] Node route_index) override {}
+    void Save([[maybe_unused]] const AlkaidSolution &solution,
+              [[maybe_unused]] const RouteContext &context) override {}
+
+    const List &Build(const Instance &instance, Node num_neighbors) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      num_neighbors = std::max(0, std::min<int>(num_neighbors, instance.num_customers - 2));
+      // Only a new instance, which no operator is reading yet, drops the lists.
+      if (instance.num_customers != num_customers_) {
+        num_customers_ = instance.num_customers;
+        lists_.clear();
+      }
+      auto [it, inserted] = lists_.try_emplace(num_neighbors);
+      auto &list = it->second;
+      if (!inserted) {
+        return list;
+      }
+      list.num_neighbors_ = num_neighbors;
+      list.neighbors_.assign(static_cast<size_t>(num_customers_) * num_neighbors, 0);
+      std::vector<Node> customers;
+      for (Node customer = 1; customer < num_customers_; ++customer) {
+        customers.clear();
+        for (Node other = 1; other < num_customers_; ++other) {
+          if (other != customer) {
+            customers.emplace_back(other);
+          }
+        }
+        auto &&distances = instance.distance_matrix[customer];
+        std::partial_sort(customers.begin(), customers.begin() + num_neighbors, customers.end(),
+                          [&](Node lhs, Node rhs) {
+                            return std::tie(distances[lhs], lhs) < std::tie(distances[rhs], rhs);
+                          });
+        std::copy(customers.begin(), customers.begin() + num_neighbors,
+                  list.neighbors_.begin() + static_cast<size_t>(customer) * num_neighbors);
+      }
+      return list;
+    }
+
+    // Locators are kept per thread since route pairs are evaluated concurrently.
+    static RouteLocator &Locator(int index) {
+      thread_local RouteLocator locators[2];
+      return locators[index];
+    }
+
+  private:
+    Node num_customers_{};
+    // A map, so that the lists keep their addresses when another one is added.
+    std::map<Node, List> lists_;
+    std::mutex mutex_;
+  };
+}  // namespace alkaidsd::inter_operator
@@ -2,6 +2,7 @@
 
 #include "base_cache.h"
 #include "base_star.h"
+#include "granular.h"
 #include "route_head_guard.h"
 
 namespace alkaidsd::inter_operator {
@@ -24,10 +25,10 @@ namespace alkaidsd::inter_operator {
     }
   }
 
+  // The star caches of the routes are preprocessed by the caller.
   void RelocateInner(const Instance &instance, const AlkaidSolution &solution, const RouteContext &context,
                      Node route_x, Node route_y, BaseCache<RelocateMove> &cache,
                      StarCaches &star_caches, Random &random) {
-    star_caches.Preprocess(instance, solution, context, route_y, random);
     Node node_x = context.Head(route_x);
     while (node_x) {
       if (context.Load(route_y) + solution.Load(node_x) <= instance.capacity) {
@@ -36,7 +37,7 @@ namespace alkaidsd::inter_operator {
         Node successor_x = solution.Successor(node_x);
         int delta = insertion->delta.value
                     - CalcDelta(instance, solution, node_x, predecessor_x, successor_x);
-        if (cache.delta.Update(delta, random)) {
+        if (cache.Update(delta, random)) {
           cache.move = {route_x, route_y, node_x, insertion->predecessor, insertion->successor};
         }
       }
@@ -44,29 +45,64 @@ namespace alkaidsd::inter_operator {
     }
   }
 
+  void GranularRelocateInner(const Instance &instance, const AlkaidSolution &solution,
+                             const RouteContext &context, Node route_x, Node route_y,
+                             BaseCache<RelocateMove> &cache,
+                             const GranularNeighbors::List &neighbors, Random &random) {
+    auto &locator = GranularNeighbors::Locator(0);
+    locator.Mark(solution, context.Head(route_y), instance.num_customers);
+    for (Node node_x = context.Head(route_x); node_x; node_x = solution.Successor(node_x)) {
+      if (context.Load(route_y) + solution.Load(node_x) > instance.capacity) {
+        continue;
+      }
+      int base = -CalcDelta(instance, solution, node_x, solution.Predecessor(node_x),
+                            solution.Successor(node_x));
+      neighbors.ForEach(solution.Customer(node_x), [&](Node customer) {
+        Node node_y = locator.Find(customer);
+        if (!node_y) {
+          return;
+        }
+        for (auto [predecessor, successor] :
+             {std::pair(solution.Predecessor(node_y), node_y),
+              std::pair(node_y, solution.Successor(node_y))}) {
+          int delta = base + CalcDelta(instance, solution, node_x, predecessor, successor);
+          if (cache.Update(delta, random)) {
+            cache.move = {route_x, route_y, node_x, predecessor, successor};
+          }
+        }
+      });
+    }
+  }
+
   std::vector<Node> inter_operator::Relocate::operator()(const Instance &instance, AlkaidSolution &solution,
                                                          RouteContext &context, Random &random,
                                                          CacheMap &cache_map) const {
-    auto &caches = cache_map.Get<InterRouteCache<RelocateMove>>(solution, context);
-    auto &star_caches = cache_map.Get<StarCaches>(solution, context);
     RelocateMove best_move{};
-    Delta<int> best_delta{};
-    for (Node route_x = 0; route_x < context.NumRoutes(); ++route_x) {
-      for (Node route_y = 0; route_y < context.NumRoutes(); ++route_y) {
-        if (route_x == route_y) {
-          continue;
-        }
-        auto &cache = caches.Get(route_x, route_y);
-        if (!cache.TryReuse()) {
-          RelocateInner(instance, solution, context, route_x, route_y, cache, star_caches, random);
-        } else {
-          cache.move.route_x = route_x;
-          cache.move.route_y = route_y;
-        }
-        if (best_delta.Update(cache.delta, random)) {
-          best_move = cache.move;
-        }
-      }
+    Delta<int> best_delta;
+    if (num_neighbors_) {
+      auto &neighbors
+          = cache_map.Get<GranularNeighbors>(solution, context).Build(instance, num_neighbors_);
+      best_delta = FindBestMove(
+          solution, context, cache_map, scan_policy_, false, random, kAllRoutePairs,
+          [&](Node route_x, Node route_y, BaseCache<RelocateMove> &cache, Random &pair_random) {
+            GranularRelocateInner(instance, solution, context, route_x, route_y, cache, neighbors,
+                                  pair_random);
+          },
+          best_move, num_neighbors_);
+    } else {
+      auto &star_caches = cache_map.Get<StarCaches>(solution, context);
+      auto statistics = cache_map.Statistics();
+      auto preprocess = [&](Node, Node route_y) {
+        star_caches.Preprocess(instance, solution, context, route_y, random, statistics);
+        return true;
+      };
+      best_delta = FindBestMove(
+          solution, context, cache_map, scan_policy_, false, random, preprocess,
+          [&](Node route_x, Node route_y, BaseCache<RelocateMove> &cache, Random &pair_random) {
+            RelocateInner(instance, solution, context, route_x, route_y, cache, star_caches,
+                          pair_random);
+          },
+          best_move);
     }
     if (best_delta.value < 0) {
       DoRelocate(best_move, solution, context);
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <alkaidsd/inter_operator.h>
+
+#include <vector>
+
+#include "../cache.h"
+
+namespace alkaidsd::inter_operator {
+  // Routes laid out in arrays, with the depot at both ends, so that operators can scan the
+  // positions of a route in branch-free loops over contiguous memory instead of following the
+  // links of the solution. Arrays are rebuilt lazily after their route changes.
+  class RouteArrays : public Cache {
+  public:
+    struct Arrays {
+      std::vector<Node> nodes;
+      std::vector<int> customers;
+      std::vector<const int *> rows;  // The distance rows of the customers.
+      std::vector<int> loads;         // loads[i] is the load of the positions before i.
+      std::vector<int> next;          // The distance from each position to the next one.
+      std::vector<int> previous;      // The distance from each position to the previous one.
+      bool outdated = true;
+
+      int Size() const { return static_cast<int>(nodes.size()); }
+    };
+
+    void Reset([[maybe_unused]] const AlkaidSolution &solution,
+               const RouteContext &context) override {
+      arrays_.resize(context.NumRoutes());
+      for (auto &arrays : arrays_) {
+        arrays.outdated = true;
+      }
+    }
+    void AddRoute(Node route_index) override {
+      if (arrays_.size() <= static_cast<size_t>(route_index)) {
+        arrays_.resize(route_index + 1);
+      }
+      arrays_[route_index].outdated = true;
+    }
+    void RemoveRoute(Node route_index) override { arrays_[route_index].outdated = true; }
+    void Save([[maybe_unused]] const AlkaidSolution &solution,
+              [[maybe_unused]] const RouteContext &context) override {}
+
+    // Rebuilds the arrays of the active routes that changed. Not safe to call concurrently.
+    void Prepare(const Instance &instance, const AlkaidSolution &solution,
+                 const RouteContext &context) {
+      for (Node route_index : context.ActiveRoutes()) {
+        if (arrays_[route_index].outdated) {
+          Build(instance, solution, context, route_index);
+        }
+      }
+    }
+
+    // The arrays of the route, which must be prepared.
+    const Arrays &Get(Node route_index) const { return arrays_[route_index]; }
+
+    // The arrays of the route, rebuilt first if it changed.
+    const Arrays &Get(const Instance &instance, const AlkaidSolution &solution,
+                      const RouteContext &context, Node route_index) {
+      if (arrays_[route_index].outdated) {
+        Build(instance, solution, context, route_index);
+      }
+      return arrays_[route_index];
+    }
+
+  private:
+    void Build(const Instance &instance, const AlkaidSolution &solution,
+               const RouteContext &context, Node route_index) {
+      auto &arrays = arrays_[route_index];
+      arrays.nodes.assign(1, 0);
+      for (Node node_index = context.Head(route_index); node_index;
+           node_index = solution.Successor(node_index)) {
+        arrays.nodes.push_back(node_index);
+      }
+      arrays.nodes.push_back(0);
+      int size = arrays.Size();
+      arrays.customers.resize(size);
+      arrays.rows.resize(size);
+      arrays.loads.resize(size + 1);
+      arrays.next.resize(size);
+      arrays.previous.resize(size);
+      arrays.loads[0] = 0;
+      for (int i = 0; i < size; ++i) {
+        arrays.customers[i] = solution.Customer(arrays.nodes[i]);
+        arrays.rows[i] = instance.distance_matrix[arrays.customers[i]].data();
+        arrays.loads[i + 1]
+            = arrays.loads[i] + (arrays.nodes[i] ? solution.Load(arrays.nodes[i]) : 0);
+      }
+      for (int i = 0; i < size; ++i) {
+        arrays.next[i] = i + 1 < size ? arrays.rows[i][arrays.customers[i + 1]] : 0;
+        arrays.previous[i] = i > 0 ? arrays.rows[i][arrays.customers[i - 1]] : 0;
+      }
+      arrays.outdated = false;
+    }
+
+    std::vector<Arrays> arrays_;
+  };
+}  // namespace alkaidsd::inter_operator
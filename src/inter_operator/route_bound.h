@@ -0,0 +1,91 @@
+#pragma once
+
+#include <alkaidsd/inter_operator.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "../cache.h"
+#include "base_star.h"
+
+namespace alkaidsd::inter_operator {
+  // Lower bounds on the delta of the star moves between two routes, computed from the star caches.
+  // They are valid when the distance matrix satisfies the triangle inequality, which
+  // DistanceMatrixOptimizer establishes. Removing a node x gains at most its removal cost
+  // r(x). Inserting x into the other route costs at least its best insertion m(x) from the star
+  // caches, and inserting it in place of a removed node y costs at least m(x) - e(y), where e(y)
+  // is the round trip along the shorter edge of y. A pair of routes can therefore only improve if
+  // the sum over both directions of min m(x) - r(x) - e(x) is negative. The slacks r(x) + e(x) are
+  // rebuilt lazily after their route changes.
+  class RouteBounds : public Cache {
+  public:
+    void Reset([[maybe_unused]] const AlkaidSolution &solution,
+               const RouteContext &context) override {
+      bounds_.assign(context.NumRoutes(), RouteBound{});
+    }
+    void AddRoute(Node route_index) override {
+      if (bounds_.size() <= static_cast<size_t>(route_index)) {
+        bounds_.resize(route_index + 1);
+      }
+      bounds_[route_index].outdated = true;
+    }
+    void RemoveRoute(Node route_index) override { bounds_[route_index].outdated = true; }
+    void Save([[maybe_unused]] const AlkaidSolution &solution,
+              [[maybe_unused]] const RouteContext &context) override {}
+
+    // The star caches of both routes must be up to date.
+    int LowerBound(const Instance &instance, const AlkaidSolution &solution,
+                   const RouteContext &context, StarCaches &star_caches, Node route_a,
+                   Node route_b) {
+      return HalfBound(instance, solution, context, star_caches, route_a, route_b)
+             + HalfBound(instance, solution, context, star_caches, route_b, route_a);
+    }
+
+  private:
+    struct RouteBound {
+      std::vector<std::pair<Node, int>> slacks;
+      bool outdated = true;
+    };
+
+    int HalfBound(const Instance &instance, const AlkaidSolution &solution,
+                  const RouteContext &context, StarCaches &star_caches, Node route_from,
+                  Node route_to) {
+      int bound = std::numeric_limits<int>::max();
+      for (auto [customer, slack] : Get(instance, solution, context, route_from).slacks) {
+        int insertion = star_caches.Get(route_to, customer).FindBest()->delta.value;
+        bound = std::min(bound, insertion - slack);
+      }
+      return bound;
+    }
+
+    const RouteBound &Get(const Instance &instance, const AlkaidSolution &solution,
+                          const RouteContext &context, Node route_index) {
+      auto &bound = bounds_[route_index];
+      if (!bound.outdated) {
+        return bound;
+      }
+      bound.slacks.clear();
+      for (Node node_index = context.Head(route_index); node_index;
+           node_index = solution.Successor(node_index)) {
+        Node customer = solution.Customer(node_index);
+        Node predecessor = solution.Customer(solution.Predecessor(node_index));
+        Node successor = solution.Customer(solution.Successor(node_index));
+        int round_trip = std::min(
+            instance.distance_matrix[predecessor][customer]
+                + instance.distance_matrix[customer][predecessor],
+            instance.distance_matrix[customer][successor]
+                + instance.distance_matrix[successor][customer]);
+        bound.slacks.emplace_back(
+            customer, CalcDelta(instance, solution, node_index, solution.Predecessor(node_index),
+                                solution.Successor(node_index))
+                          + round_trip);
+      }
+      bound.outdated = false;
+      return bound;
+    }
+
+    std::vector<RouteBound> bounds_;
+  };
+}  // namespace alkaidsd::inter_operator
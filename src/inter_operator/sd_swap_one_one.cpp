@@ -2,6 +2,7 @@
 
 #include "base_cache.h"
 #include "base_star.h"
+#include "granular.h"
 #include "route_head_guard.h"
 
 namespace alkaidsd::inter_operator {
@@ -55,26 +56,63 @@ namespace alkaidsd::inter_operator {
       delta_y = after;
     }
     delta += delta_x + delta_y;
-    if (cache.delta.Update(delta, random)) {
+    if (cache.Update(delta, random)) {
       cache.move = {swapped,     route_x, route_y,     node_x,    predecessor_y,
                     successor_y, node_y,  predecessor, successor, split_load};
     }
   }
 
+  void UpdateSdSwapOneOne(const Instance &instance, const AlkaidSolution &solution,
+                          const RouteContext &context, Node route_x, Node route_y, Node node_x,
+                          Node node_y, BaseCache<SdSwapOneOneMove> &cache, Random &random) {
+    int load_x = solution.Load(node_x);
+    int load_y = solution.Load(node_y);
+    if (load_x > load_y) {
+      SdSwapOneOneInner(instance, solution, context, false, route_x, route_y, node_x, node_y,
+                        load_x - load_y, cache, random);
+    } else if (load_y > load_x) {
+      SdSwapOneOneInner(instance, solution, context, true, route_y, route_x, node_y, node_x,
+                        load_y - load_x, cache, random);
+    }
+  }
+
   void SdSwapOneOneInner(const Instance &instance, const AlkaidSolution &solution,
                          const RouteContext &context, Node route_x, Node route_y,
                          BaseCache<SdSwapOneOneMove> &cache, Random &random) {
     for (Node node_x = context.Head(route_x); node_x; node_x = solution.Successor(node_x)) {
-      int load_x = solution.Load(node_x);
       for (Node node_y = context.Head(route_y); node_y; node_y = solution.Successor(node_y)) {
-        int load_y = solution.Load(node_y);
-        if (load_x > load_y) {
-          SdSwapOneOneInner(instance, solution, context, false, route_x, route_y, node_x, node_y,
-                            load_x - load_y, cache, random);
-        } else if (load_y > load_x) {
-          SdSwapOneOneInner(instance, solution, context, true, route_y, route_x, node_y, node_x,
-                            load_y - load_x, cache, random);
-        }
+        UpdateSdSwapOneOne(instance, solution, context, route_x, route_y, node_x, node_y, cache,
+                           random);
+      }
+    }
+  }
+
+  // The two swapped nodes end up next to each other and next to the neighbors of each other's old
+  // position, so node_y is tried on and around every neighbor of node_x, and vice versa.
+  void GranularSdSwapOneOneInner(const Instance &instance, const AlkaidSolution &solution,
+                                 const RouteContext &context, Node route_x, Node route_y,
+                                 BaseCache<SdSwapOneOneMove> &cache,
+                                 const GranularNeighbors::List &neighbors, Random &random) {
+    auto &locator_x = GranularNeighbors::Locator(0);
+    auto &locator_y = GranularNeighbors::Locator(1);
+    locator_x.Mark(solution, context.Head(route_x), instance.num_customers);
+    locator_y.Mark(solution, context.Head(route_y), instance.num_customers);
+    for (bool swapped : {false, true}) {
+      Node route_a = swapped ? route_y : route_x;
+      auto &locator_b = swapped ? locator_x : locator_y;
+      for (Node node_a = context.Head(route_a); node_a; node_a = solution.Successor(node_a)) {
+        neighbors.ForEach(solution.Customer(node_a), [&](Node customer) {
+          Node node_b = locator_b.Find(customer);
+          if (!node_b) {
+            return;
+          }
+          for (Node node : {solution.Predecessor(node_b), node_b, solution.Successor(node_b)}) {
+            if (node) {
+              UpdateSdSwapOneOne(instance, solution, context, route_x, route_y,
+                                 swapped ? node : node_a, swapped ? node_a : node, cache, random);
+            }
+          }
+        });
       }
     }
   }
@@ -83,27 +121,25 @@ namespace alkaidsd::inter_operator {
                                                              AlkaidSolution &solution,
                                                              RouteContext &context, Random &random,
                                                              CacheMap &cache_map) const {
-    auto &caches = cache_map.Get<InterRouteCache<SdSwapOneOneMove>>(solution, context);
     SdSwapOneOneMove best_move{};
-    Delta<int> best_delta{};
-    for (Node route_x = 0; route_x < context.NumRoutes(); ++route_x) {
-      for (Node route_y = route_x + 1; route_y < context.NumRoutes(); ++route_y) {
-        auto &cache = caches.Get(route_x, route_y);
-        if (!cache.TryReuse()) {
-          SdSwapOneOneInner(instance, solution, context, route_x, route_y, cache, random);
-        } else {
-          if (!cache.move.swapped) {
-            cache.move.route_x = route_x;
-            cache.move.route_y = route_y;
-          } else {
-            cache.move.route_x = route_y;
-            cache.move.route_y = route_x;
-          }
-        }
-        if (best_delta.Update(cache.delta, random)) {
-          best_move = cache.move;
-        }
-      }
+    Delta<int> best_delta;
+    if (num_neighbors_) {
+      auto &neighbors
+          = cache_map.Get<GranularNeighbors>(solution, context).Build(instance, num_neighbors_);
+      best_delta = FindBestMove(
+          solution, context, cache_map, scan_policy_, true, random, kAllRoutePairs,
+          [&](Node route_x, Node route_y, BaseCache<SdSwapOneOneMove> &cache, Random &pair_random) {
+            GranularSdSwapOneOneInner(instance, solution, context, route_x, route_y, cache,
+                                      neighbors, pair_random);
+          },
+          best_move, num_neighbors_);
+    } else {
+      best_delta = FindBestMove(
+          solution, context, cache_map, scan_policy_, true, random,
+          [&](Node route_x, Node route_y, BaseCache<SdSwapOneOneMove> &cache, Random &pair_random) {
+            SdSwapOneOneInner(instance, solution, context, route_x, route_y, cache, pair_random);
+          },
+          best_move);
     }
     if (best_delta.value < 0) {
       DoSdSwapOneOne(best_move, solution, context);
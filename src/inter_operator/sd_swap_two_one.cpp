@@ -119,7 +119,7 @@ namespace alkaidsd::inter_operator {
     int delta = base_delta
                 + instance.distance_matrix[solution.Customer(node_j)][solution.Customer(node_k)]
                 + delta_ij + delta_jk;
-    if (cache.delta.Update(delta, random)) {
+    if (cache.Update(delta, random)) {
       cache.move = {0,      route_ij, route_k,    predecessor_ij, successor_ij, node_i,
                     node_j, node_k,   split_load, direction_ij,   direction_jk};
     }
@@ -158,7 +158,7 @@ namespace alkaidsd::inter_operator {
                       .distance_matrix[solution.Customer(after_ij)][solution.Customer(successor_k)];
         }
         int delta = base_delta + delta_ijk;
-        if (cache.delta.Update(delta, random)) {
+        if (cache.Update(delta, random)) {
           cache.move = {1,      route_ij, route_k,    predecessor_ij, successor_ij, node_i,
                         node_j, node_k,   split_load, direction_ij,   direction_ijk};
         }
@@ -211,26 +211,13 @@ namespace alkaidsd::inter_operator {
                                                              AlkaidSolution &solution,
                                                              RouteContext &context, Random &random,
                                                              CacheMap &cache_map) const {
-    auto &caches = cache_map.Get<InterRouteCache<SdSwapTwoOneMove>>(solution, context);
     SdSwapTwoOneMove best_move{};
-    Delta<int> best_delta{};
-    for (Node route_ij = 0; route_ij < context.NumRoutes(); ++route_ij) {
-      for (Node route_k = 0; route_k < context.NumRoutes(); ++route_k) {
-        if (route_ij == route_k) {
-          continue;
-        }
-        auto &cache = caches.Get(route_ij, route_k);
-        if (!cache.TryReuse()) {
-          SdSwapTwoOneInner(instance, solution, context, route_ij, route_k, cache, random);
-        } else {
-          cache.move.route_ij = route_ij;
-          cache.move.route_k = route_k;
-        }
-        if (best_delta.Update(cache.delta, random)) {
-          best_move = cache.move;
-        }
-      }
-    }
+    auto best_delta = FindBestMove(
+        solution, context, cache_map, scan_policy_, false, random,
+        [&](Node route_ij, Node route_k, BaseCache<SdSwapTwoOneMove> &cache, Random &pair_random) {
+          SdSwapTwoOneInner(instance, solution, context, route_ij, route_k, cache, pair_random);
+        },
+        best_move);
     if (best_delta.value < 0) {
       DoSdSwapTwoOne(best_move, solution, context);
       return {best_move.route_ij, best_move.route_k};
@@ -1,6 +1,11 @@
 #include <alkaidsd/inter_operator.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "base_cache.h"
+#include "granular.h"
+#include "route_arrays.h"
 
 namespace alkaidsd::inter_operator {
   template <int, int> struct SwapMove {
@@ -61,7 +66,7 @@ namespace alkaidsd::inter_operator {
     int direction = d1 >= d2;
     int delta = base_x + (direction ? d2 : d1)
                 - instance.distance_matrix[customer_predecessor][customer_successor];
-    if (cache.delta.Update(delta, random)) {
+    if (cache.Update(delta, random)) {
       cache.move = {route_x, route_y, direction, -1, left, predecessor, right, successor};
     }
   }
@@ -91,95 +96,228 @@ namespace alkaidsd::inter_operator {
     int delta = base_x + (direction_x ? d2 : d1) + (direction_y ? d4 : d3)
                 - instance.distance_matrix[customer_left_y][predecessor_y]
                 - instance.distance_matrix[customer_right_y][successor_y];
-    if (cache.delta.Update(delta, random)) {
+    if (cache.Update(delta, random)) {
       cache.move = {route_x, route_y, direction_x, direction_y, left_x, left_y, right_x, right_y};
     }
   }
 
+  // Scans the segments of route x against all positions of route y over the arrays of both
+  // routes, so that the inner loop reads contiguous memory and the terms of route x are hoisted
+  // out of it. The arrays of the routes are prepared by the caller.
   template <int num_x, int num_y>
-  void SwapInner(const Instance &instance, AlkaidSolution &solution, RouteContext &context, Node route_x,
-                 Node route_y, BaseCache<SwapMove<num_x, num_y>> &cache, Random &random) {
-    Node left_x = context.Head(route_x);
-    int load_x = solution.Load(left_x);
-    Node right_x = left_x;
-    for (int i = 1; right_x && i < num_x; ++i) {
-      right_x = solution.Successor(right_x);
-      load_x += solution.Load(right_x);
-    }
-    while (right_x) {
-      int base_x = -instance.distance_matrix[solution.Customer(left_x)]
-                                           [solution.Customer(solution.Predecessor(left_x))]
-                   - instance.distance_matrix[solution.Customer(right_x)]
-                                            [solution.Customer(solution.Successor(right_x))];
-      if (num_y == 0) {
-        base_x += instance.distance_matrix[solution.Customer(solution.Predecessor(left_x))]
-                                         [solution.Customer(solution.Successor(right_x))];
-      }
+  void SwapInner(const Instance &instance, const RouteContext &context, Node route_x,
+                 Node route_y, BaseCache<SwapMove<num_x, num_y>> &cache,
+                 const RouteArrays &route_arrays, Random &random) {
+    auto &arrays_x = route_arrays.Get(route_x);
+    auto &arrays_y = route_arrays.Get(route_y);
+    const int *customers_y = arrays_y.customers.data();
+    const int *const *rows_y = arrays_y.rows.data();
+    const int *loads_y = arrays_y.loads.data();
+    const int *next_y = arrays_y.next.data();
+    const int *previous_y = arrays_y.previous.data();
+    int size_y = arrays_y.Size();
+    int num_feasible = 0;
+    for (int i = 1; i + num_x < arrays_x.Size(); ++i) {
+      int right = i + num_x - 1;
+      int predecessor_x = arrays_x.customers[i - 1];
+      int successor_x = arrays_x.customers[right + 1];
+      const int *row_left_x = arrays_x.rows[i];
+      const int *row_right_x = arrays_x.rows[right];
+      int load_x = arrays_x.loads[right + 1] - arrays_x.loads[i];
+      int base_x = -arrays_x.previous[i] - arrays_x.next[right];
       int load_y_lower = -instance.capacity + context.Load(route_y) + load_x;
       if (num_y == 0) {
-        if (load_y_lower <= 0) {
-          Node predecessor = 0;
-          Node successor = context.Head(route_y);
-          while (true) {
-            UpdateShift(instance, solution, route_x, route_y, left_x, right_x, predecessor,
-                        successor, base_x, cache, random);
-            if (!successor) {
-              break;
-            }
-            predecessor = successor;
-            successor = solution.Successor(successor);
+        if (load_y_lower > 0) {
+          continue;
+        }
+        base_x += arrays_x.rows[i - 1][successor_x];
+        // Shifts insert the segment at the edges [0, size_y - 1).
+        num_feasible += size_y - 1;
+        for (int p = 0; p + 1 < size_y; ++p) {
+          int d1 = row_left_x[customers_y[p]] + row_right_x[customers_y[p + 1]];
+          int d2 = row_left_x[customers_y[p + 1]] + row_right_x[customers_y[p]];
+          int delta = base_x + std::min(d1, d2) - next_y[p];
+          if (cache.delta.Update(delta, random)) {
+            cache.move = {route_x, route_y, d1 >= d2, -1, arrays_x.nodes[i], arrays_y.nodes[p],
+                          arrays_x.nodes[right], arrays_y.nodes[p + 1]};
           }
         }
       } else {
         int load_y_upper = instance.capacity - context.Load(route_x) + load_x;
-        Node left_y = context.Head(route_y);
-        int load_y = solution.Load(left_y);
-        Node right_y = left_y;
-        for (int i = 1; right_y && i < num_y; ++i) {
-          right_y = solution.Successor(right_y);
-          load_y += solution.Load(right_y);
+        // Swaps exchange the segment with the segments starting at [1, size_y - num_y).
+        for (int p = 1; p + num_y < size_y; ++p) {
+          int load_y = loads_y[p + num_y] - loads_y[p];
+          if (load_y < load_y_lower || load_y > load_y_upper) {
+            continue;
+          }
+          ++num_feasible;
+          int predecessor_y = customers_y[p - 1];
+          int successor_y = customers_y[p + num_y];
+          int d1 = row_left_x[predecessor_y] + row_right_x[successor_y];
+          int d2 = row_left_x[successor_y] + row_right_x[predecessor_y];
+          int d3 = rows_y[p][predecessor_x] + rows_y[p + num_y - 1][successor_x];
+          int d4 = rows_y[p][successor_x] + rows_y[p + num_y - 1][predecessor_x];
+          int delta = base_x + std::min(d1, d2) + std::min(d3, d4) - previous_y[p]
+                      - next_y[p + num_y - 1];
+          if (cache.delta.Update(delta, random)) {
+            cache.move = {route_x,           route_y,
+                          d1 >= d2,          d3 >= d4,
+                          arrays_x.nodes[i], arrays_y.nodes[p],
+                          arrays_x.nodes[right], arrays_y.nodes[p + num_y - 1]};
+          }
+        }
+      }
+    }
+    cache.num_evaluations += num_feasible;
+  }
+
+  // Returns the last node of the segment of the given length starting at left, or 0 if the route
+  // ends before.
+  Node SegmentEnd(const AlkaidSolution &solution, Node left, int length) {
+    for (int i = 1; left && i < length; ++i) {
+      left = solution.Successor(left);
+    }
+    return left;
+  }
+
+  // Returns the first node of the segment of the given length ending at right, or 0 if the route
+  // starts after.
+  Node SegmentBegin(const AlkaidSolution &solution, Node right, int length) {
+    for (int i = 1; right && i < length; ++i) {
+      right = solution.Predecessor(right);
+    }
+    return right;
+  }
+
+  // Evaluates the moves that put one end of a segment next to a neighbor of that end in the other
+  // route. Moving the segment of route_x next to node_y means shifting it before or after node_y
+  // when num_y == 0, and swapping it with the segment of route_y right after or right before
+  // node_y otherwise. Swaps are also searched from the segments of route_y.
+  template <int num_x, int num_y>
+  void GranularSwapInner(const Instance &instance, const AlkaidSolution &solution,
+                         const RouteContext &context, Node route_x, Node route_y,
+                         BaseCache<SwapMove<num_x, num_y>> &cache,
+                         const GranularNeighbors::List &neighbors, Random &random) {
+    auto segment_load = [&](Node left, Node right) {
+      int load = solution.Load(left);
+      while (left != right) {
+        left = solution.Successor(left);
+        load += solution.Load(left);
+      }
+      return load;
+    };
+    auto removal_delta = [&](Node left, Node right) {
+      Node predecessor = solution.Customer(solution.Predecessor(left));
+      Node successor = solution.Customer(solution.Successor(right));
+      int delta = -instance.distance_matrix[solution.Customer(left)][predecessor]
+                  - instance.distance_matrix[solution.Customer(right)][successor];
+      if (num_y == 0) {
+        delta += instance.distance_matrix[predecessor][successor];
+      }
+      return delta;
+    };
+    auto shift = [&](Node left_x, Node right_x, Node predecessor, Node successor) {
+      if (context.Load(route_y) + segment_load(left_x, right_x) <= instance.capacity) {
+        UpdateShift(instance, solution, route_x, route_y, left_x, right_x, predecessor, successor,
+                    removal_delta(left_x, right_x), cache, random);
+      }
+    };
+    auto swap = [&](Node left_x, Node left_y) {
+      Node right_x = SegmentEnd(solution, left_x, num_x);
+      Node right_y = SegmentEnd(solution, left_y, num_y);
+      if (!left_x || !right_x || !left_y || !right_y) {
+        return;
+      }
+      int load_x = segment_load(left_x, right_x);
+      int load_y = segment_load(left_y, right_y);
+      if (load_y >= -instance.capacity + context.Load(route_y) + load_x
+          && load_y <= instance.capacity - context.Load(route_x) + load_x) {
+        UpdateSwap(instance, solution, route_x, route_y, left_x, right_x, left_y, right_y,
+                   removal_delta(left_x, right_x), cache, random);
+      }
+    };
+    auto &locator_x = GranularNeighbors::Locator(0);
+    auto &locator_y = GranularNeighbors::Locator(1);
+    locator_y.Mark(solution, context.Head(route_y), instance.num_customers);
+    for (Node left_x = context.Head(route_x); left_x; left_x = solution.Successor(left_x)) {
+      Node right_x = SegmentEnd(solution, left_x, num_x);
+      if (!right_x) {
+        break;
+      }
+      for (Node end_x : {left_x, right_x}) {
+        neighbors.ForEach(solution.Customer(end_x), [&](Node customer) {
+          Node node_y = locator_y.Find(customer);
+          if (!node_y) {
+            return;
+          }
+          if (num_y == 0) {
+            shift(left_x, right_x, solution.Predecessor(node_y), node_y);
+            shift(left_x, right_x, node_y, solution.Successor(node_y));
+          } else {
+            swap(left_x, solution.Successor(node_y));
+            swap(left_x, SegmentBegin(solution, solution.Predecessor(node_y), num_y));
+          }
+        });
+        // A segment of one node has a single end.
+        if (left_x == right_x) {
+          break;
         }
-        while (right_y) {
-          if (load_y >= load_y_lower && load_y <= load_y_upper) {
-            UpdateSwap(instance, solution, route_x, route_y, left_x, right_x, left_y, right_y,
-                       base_x, cache, random);
+      }
+    }
+    if (num_y == 0) {
+      return;
+    }
+    locator_x.Mark(solution, context.Head(route_x), instance.num_customers);
+    for (Node left_y = context.Head(route_y); left_y; left_y = solution.Successor(left_y)) {
+      Node right_y = SegmentEnd(solution, left_y, num_y);
+      if (!right_y) {
+        break;
+      }
+      for (Node end_y : {left_y, right_y}) {
+        neighbors.ForEach(solution.Customer(end_y), [&](Node customer) {
+          Node node_x = locator_x.Find(customer);
+          if (node_x) {
+            swap(solution.Successor(node_x), left_y);
+            swap(SegmentBegin(solution, solution.Predecessor(node_x), num_x), left_y);
           }
-          load_y -= solution.Load(left_y);
-          left_y = solution.Successor(left_y);
-          right_y = solution.Successor(right_y);
-          load_y += solution.Load(right_y);
+        });
+        if (left_y == right_y) {
+          break;
         }
       }
-      load_x -= solution.Load(left_x);
-      left_x = solution.Successor(left_x);
-      right_x = solution.Successor(right_x);
-      load_x += solution.Load(right_x);
     }
   }
 
   template <int num_x, int num_y> std::vector<Node> inter_operator::Swap<num_x, num_y>::operator()(
       const Instance &instance, AlkaidSolution &solution, RouteContext &context, Random &random,
       CacheMap &cache_map) const {
-    auto &caches = cache_map.Get<InterRouteCache<SwapMove<num_x, num_y>>>(solution, context);
     SwapMove<num_x, num_y> best_move{};
-    Delta<int> best_delta{};
-    for (Node route_x = 0; route_x < context.NumRoutes(); ++route_x) {
-      for (Node route_y = num_x != num_y ? 0 : route_x + 1; route_y < context.NumRoutes();
-           ++route_y) {
-        if (num_x != num_y && route_x == route_y) {
-          continue;
-        }
-        auto &cache = caches.Get(route_x, route_y);
-        if (!cache.TryReuse()) {
-          SwapInner<num_x, num_y>(instance, solution, context, route_x, route_y, cache, random);
-        } else {
-          cache.move.route_x = route_x;
-          cache.move.route_y = route_y;
-        }
-        if (best_delta.Update(cache.delta, random)) {
-          best_move = cache.move;
-        }
+    Delta<int> best_delta;
+    if (num_neighbors_) {
+      auto &neighbors
+          = cache_map.Get<GranularNeighbors>(solution, context).Build(instance, num_neighbors_);
+      best_delta = FindBestMove(
+          solution, context, cache_map, scan_policy_, num_x == num_y, random, kAllRoutePairs,
+          [&](Node route_x, Node route_y, BaseCache<SwapMove<num_x, num_y>> &cache,
+              Random &pair_random) {
+            GranularSwapInner<num_x, num_y>(instance, solution, context, route_x, route_y, cache,
+                                             neighbors, pair_random);
+          },
+          best_move, num_neighbors_);
+    } else {
+      auto &route_arrays = cache_map.Get<RouteArrays>(solution, context);
+      {
+        std::lock_guard<std::mutex> lock(cache_map.Mutex());
+        route_arrays.Prepare(instance, solution, context);
       }
+      best_delta = FindBestMove(
+          solution, context, cache_map, scan_policy_, num_x == num_y, random,
+          [&](Node route_x, Node route_y, BaseCache<SwapMove<num_x, num_y>> &cache,
+              Random &pair_random) {
+            SwapInner<num_x, num_y>(instance, context, route_x, route_y, cache, route_arrays,
+                                    pair_random);
+          },
+          best_move);
     }
     if (best_delta.value < 0) {
       DoSwap(best_move, solution, context);
@@ -4,6 +4,8 @@
 
 #include "base_cache.h"
 #include "base_star.h"
+#include "bounding_circle.h"
+#include "route_bound.h"
 #include "route_head_guard.h"
 
 namespace alkaidsd::inter_operator {
@@ -32,11 +34,10 @@ namespace alkaidsd::inter_operator {
     }
   }
 
+  // The star caches of the routes are preprocessed by the caller.
   void SwapStarInner(const Instance &instance, const AlkaidSolution &solution, const RouteContext &context,
                      Node route_x, Node route_y, BaseCache<SwapStarMove> &cache,
                      StarCaches &star_caches, Random &random) {
-    star_caches.Preprocess(instance, solution, context, route_x, random);
-    star_caches.Preprocess(instance, solution, context, route_y, random);
     Node node_x = context.Head(route_x);
     while (node_x) {
       auto &&insertion_x = star_caches.Get(route_y, solution.Customer(node_x));
@@ -69,7 +70,7 @@ namespace alkaidsd::inter_operator {
             successor_x = best_insertion_y->successor;
           }
           delta += delta_x + delta_y;
-          if (cache.delta.Update(delta, random)) {
+          if (cache.Update(delta, random)) {
             cache.move = {route_x,     route_y, node_x,        predecessor_y,
                           successor_y, node_y,  predecessor_x, successor_x};
           }
@@ -83,24 +84,29 @@ namespace alkaidsd::inter_operator {
   std::vector<Node> inter_operator::SwapStar::operator()(const Instance &instance, AlkaidSolution &solution,
                                                          RouteContext &context, Random &random,
                                                          CacheMap &cache_map) const {
-    auto &caches = cache_map.Get<InterRouteCache<SwapStarMove>>(solution, context);
     auto &star_caches = cache_map.Get<StarCaches>(solution, context);
-    SwapStarMove best_move{};
-    Delta<int> best_delta{};
-    for (Node route_x = 0; route_x < context.NumRoutes(); ++route_x) {
-      for (Node route_y = route_x + 1; route_y < context.NumRoutes(); ++route_y) {
-        auto &cache = caches.Get(route_x, route_y);
-        if (!cache.TryReuse()) {
-          SwapStarInner(instance, solution, context, route_x, route_y, cache, star_caches, random);
-        } else {
-          cache.move.route_x = route_x;
-          cache.move.route_y = route_y;
-        }
-        if (best_delta.Update(cache.delta, random)) {
-          best_move = cache.move;
-        }
+    // The circles and bounds are only kept up to date when they filter the route pairs.
+    auto circles
+        = filter_route_pairs_ ? &cache_map.Get<BoundingCircles>(solution, context) : nullptr;
+    auto bounds = prune_route_pairs_ ? &cache_map.Get<RouteBounds>(solution, context) : nullptr;
+    auto statistics = cache_map.Statistics();
+    auto filter = [&](Node route_x, Node route_y) {
+      if (circles && !circles->Overlap(instance, solution, context, route_x, route_y)) {
+        return false;
       }
-    }
+      star_caches.Preprocess(instance, solution, context, route_x, random, statistics);
+      star_caches.Preprocess(instance, solution, context, route_y, random, statistics);
+      return !bounds
+             || bounds->LowerBound(instance, solution, context, star_caches, route_x, route_y) < 0;
+    };
+    SwapStarMove best_move{};
+    auto best_delta = FindBestMove(
+        solution, context, cache_map, scan_policy_, true, random, filter,
+        [&](Node route_x, Node route_y, BaseCache<SwapStarMove> &cache, Random &pair_random) {
+          SwapStarInner(instance, solution, context, route_x, route_y, cache, star_caches,
+                        pair_random);
+        },
+        best_move);
     if (best_delta.value < 0) {
       DoSwapStar(best_move, solution, context);
       return {best_move.route_x, best_move.route_y};
@@ -0,0 +1,97 @@
+#include <alkaidsd/intra_operator.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "../route_context.h"
+
+namespace alkaidsd::intra_operator {
+  bool intra_operator::HeldKarp::operator()(const Instance &instance, Node route_index,
+                                            AlkaidSolution &solution, RouteContext &context,
+                                            [[maybe_unused]] Random &random) const {
+    // The table is reused across calls and kept per thread since operators are shared.
+    thread_local std::vector<int> costs;
+    std::vector<Node> nodes;
+    std::vector<Node> customers;
+    int route_cost = 0;
+    Node predecessor = 0;
+    for (Node node_index = context.Head(route_index); node_index;
+         node_index = solution.Successor(node_index)) {
+      nodes.emplace_back(node_index);
+      customers.emplace_back(solution.Customer(node_index));
+      route_cost += instance.distance_matrix[solution.Customer(predecessor)][customers.back()];
+      predecessor = node_index;
+    }
+    int num_nodes = static_cast<int>(nodes.size());
+    if (num_nodes < 2 || num_nodes > max_size_) {
+      return false;
+    }
+    route_cost += instance.distance_matrix[customers.back()][0];
+    // costs[mask * num_nodes + last] is the shortest path from the depot through the nodes in
+    // mask that ends at last.
+    int full_mask = (1 << num_nodes) - 1;
+    costs.resize(static_cast<size_t>(full_mask + 1) * num_nodes);
+    for (int mask = 1; mask <= full_mask; ++mask) {
+      int *mask_costs = &costs[static_cast<size_t>(mask) * num_nodes];
+      for (int last = 0; last < num_nodes; ++last) {
+        if (!(mask >> last & 1)) {
+          continue;
+        }
+        int previous_mask = mask ^ (1 << last);
+        if (!previous_mask) {
+          mask_costs[last] = instance.distance_matrix[0][customers[last]];
+          continue;
+        }
+        const int *previous_costs = &costs[static_cast<size_t>(previous_mask) * num_nodes];
+        int cost = std::numeric_limits<int>::max();
+        for (int i = 0; i < num_nodes; ++i) {
+          if (previous_mask >> i & 1) {
+            cost = std::min(
+                cost, previous_costs[i] + instance.distance_matrix[customers[i]][customers[last]]);
+          }
+        }
+        mask_costs[last] = cost;
+      }
+    }
+    const int *full_costs = &costs[static_cast<size_t>(full_mask) * num_nodes];
+    int best_cost = std::numeric_limits<int>::max();
+    int last = 0;
+    for (int i = 0; i < num_nodes; ++i) {
+      int cost = full_costs[i] + instance.distance_matrix[customers[i]][0];
+      if (cost < best_cost) {
+        best_cost = cost;
+        last = i;
+      }
+    }
+    if (best_cost >= route_cost) {
+      return false;
+    }
+    std::vector<Node> order{nodes[last]};
+    int mask = full_mask;
+    while (mask != 1 << last) {
+      int previous_mask = mask ^ (1 << last);
+      int cost = costs[static_cast<size_t>(mask) * num_nodes + last];
+      const int *previous_costs = &costs[static_cast<size_t>(previous_mask) * num_nodes];
+      int previous = 0;
+      while (!(previous_mask >> previous & 1)
+             || previous_costs[previous]
+                        + instance.distance_matrix[customers[previous]][customers[last]]
+                    != cost) {
+        ++previous;
+      }
+      order.emplace_back(nodes[previous]);
+      mask = previous_mask;
+      last = previous;
+    }
+    std::reverse(order.begin(), order.end());
+    solution.Link(0, order.front());
+    for (int i = 0; i + 1 < num_nodes; ++i) {
+      solution.Link(order[i], order[i + 1]);
+    }
+    solution.Link(order.back(), 0);
+    context.SetHead(route_index, order.front());
+    context.UpdateRouteContext(solution, route_index, 0);
+    return true;
+  }
+}  // namespace alkaidsd::intra_operator
@@ -0,0 +1,73 @@
+#include <alkaidsd/intra_operator.h>
+
+#include <limits>
+#include <vector>
+
+#include "../delta.h"
+#include "../route_context.h"
+
+namespace alkaidsd::intra_operator {
+  struct TwoOptMove {
+    int left;
+    int right;
+  };
+
+  bool intra_operator::TwoOpt::operator()(const Instance &instance, Node route_index,
+                                          AlkaidSolution &solution, RouteContext &context,
+                                          Random &random) const {
+    // The route with the depot on both ends. forward[i] and backward[i] are the costs of
+    // traversing nodes 0..i forwards and backwards, so that reversing the segment i..j changes
+    // its internal cost by (backward[j] - backward[i]) - (forward[j] - forward[i]).
+    std::vector<Node> nodes{0};
+    std::vector<Node> customers{0};
+    for (Node node_index = context.Head(route_index); node_index;
+         node_index = solution.Successor(node_index)) {
+      nodes.emplace_back(node_index);
+      customers.emplace_back(solution.Customer(node_index));
+    }
+    nodes.emplace_back(0);
+    customers.emplace_back(0);
+    int num_nodes = static_cast<int>(nodes.size());
+    std::vector<int> forward(num_nodes), backward(num_nodes);
+    for (int i = 1; i < num_nodes; ++i) {
+      forward[i] = forward[i - 1] + instance.distance_matrix[customers[i - 1]][customers[i]];
+      backward[i] = backward[i - 1] + instance.distance_matrix[customers[i]][customers[i - 1]];
+    }
+    int threshold = std::numeric_limits<int>::max();
+    if (sparsification_ > 0) {
+      threshold = static_cast<int>(sparsification_ * forward.back() / (num_nodes - 1));
+    }
+    TwoOptMove best_move{};
+    Delta<int> best_delta{};
+    for (int left = 1; left + 2 < num_nodes; ++left) {
+      Node predecessor = customers[left - 1];
+      Node first = customers[left];
+      int left_terms = instance.distance_matrix[predecessor][first] - forward[left] + backward[left];
+      for (int right = left + 1; right + 1 < num_nodes; ++right) {
+        Node last = customers[right];
+        Node successor = customers[right + 1];
+        int added_a = instance.distance_matrix[predecessor][last];
+        int added_b = instance.distance_matrix[first][successor];
+        if (added_a > threshold && added_b > threshold) {
+          continue;
+        }
+        int delta = added_a + added_b + backward[right] - forward[right] - left_terms
+                    - instance.distance_matrix[last][successor];
+        if (best_delta.Update(delta, random)) {
+          best_move = {left, right};
+        }
+      }
+    }
+    if (best_delta.value < 0) {
+      Node predecessor = nodes[best_move.left - 1];
+      solution.ReversedLink(nodes[best_move.left], nodes[best_move.right], predecessor,
+                            nodes[best_move.right + 1]);
+      if (!predecessor) {
+        context.SetHead(route_index, nodes[best_move.right]);
+      }
+      context.UpdateRouteContext(solution, route_index, predecessor);
+      return true;
+    }
+    return false;
+  }
+}  // namespace alkaidsd::intra_operator
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <vector>
+
+#include "random.h"
+
+namespace alkaidsd {
+  // Orders operators by a roulette over their recent improvement per microsecond. Weights are
+  // exponential moving averages updated after every call, and each operator keeps at least
+  // kMinShare of the largest weight so that it is still tried from time to time. Without
+  // adaptation the order is a uniform shuffle.
+  class OperatorSelector {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    OperatorSelector(size_t num_operators, bool adaptive, double decay)
+        : adaptive_(adaptive), decay_(decay), weights_(num_operators) {}
+
+    bool Adaptive() const { return adaptive_; }
+    const std::vector<double> &Weights() const { return weights_; }
+
+    void Order(std::vector<int> &order, Random &random) const {
+      order.resize(weights_.size());
+      std::iota(order.begin(), order.end(), 0);
+      if (!adaptive_) {
+        random.Shuffle(order.begin(), order.end());
+        return;
+      }
+      double max_weight = *std::max_element(weights_.begin(), weights_.end());
+      double min_weight = max_weight > 0 ? max_weight * kMinShare : 1.0;
+      for (size_t i = 0; i + 1 < order.size(); ++i) {
+        double total_weight = 0;
+        for (size_t j = i; j < order.size(); ++j) {
+          total_weight += std::max(weights_[order[j]], min_weight);
+        }
+        double target = random.NextFloat() * total_weight;
+        size_t k = i;
+        while (k + 1 < order.size()) {
+          target -= std::max(weights_[order[k]], min_weight);
+          if (target < 0) {
+            break;
+          }
+          ++k;
+        }
+        std::swap(order[i], order[k]);
+      }
+    }
+
+    void Reward(int index, int improvement, Clock::time_point start_time) {
+      if (!adaptive_) {
+        return;
+      }
+      Reward(index, improvement,
+             std::chrono::duration<double, std::micro>(Clock::now() - start_time).count());
+    }
+
+    void Reward(int index, int improvement, double microseconds) {
+      if (!adaptive_) {
+        return;
+      }
+      double score = improvement / std::max(microseconds, 1e-3);
+      weights_[index] = decay_ * weights_[index] + (1 - decay_) * score;
+    }
+
+  private:
+    static constexpr double kMinShare = 0.05;
+
+    bool adaptive_;
+    double decay_;
+    std::vector<double> weights_;
+  };
+}  // namespace alkaidsd
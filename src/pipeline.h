@@ -0,0 +1,162 @@
+#pragma once
+
+#include <alkaidsd/config.h>
+#include <alkaidsd/solver.h>
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace alkaidsd {
+  // Calls the operators, the acceptance rule and the ruin method of the config through their
+  // virtual interfaces, so that any combination can be configured at run time.
+  class DynamicPipeline {
+  public:
+    explicit DynamicPipeline(const AlkaidConfig &config) : config_(config) {}
+
+    int NumInterOperators() const { return static_cast<int>(config_.inter_operators.size()); }
+    int NumIntraOperators() const { return static_cast<int>(config_.intra_operators.size()); }
+
+    std::vector<Node> Inter(int index, const Instance &instance, AlkaidSolution &solution,
+                            RouteContext &context, Random &random, CacheMap &cache_map) const {
+      return (*config_.inter_operators[index])(instance, solution, context, random, cache_map);
+    }
+
+    bool Intra(int index, const Instance &instance, Node route_index, AlkaidSolution &solution,
+               RouteContext &context, Random &random) const {
+      return (*config_.intra_operators[index])(instance, route_index, solution, context, random);
+    }
+
+    bool IsExact(int index, Node num_nodes) const {
+      return config_.intra_operators[index]->IsExact(num_nodes);
+    }
+
+    std::unique_ptr<acceptance_rule::AcceptanceRule> MakeAcceptanceRule() const {
+      return config_.acceptance_rule();
+    }
+
+    bool Accept(acceptance_rule::AcceptanceRule &acceptance_rule, int old_value, int new_value,
+                Random &random) const {
+      return acceptance_rule.Accept(old_value, new_value, random);
+    }
+
+    void ResetRuin(const Instance &instance) const { config_.ruin_method->Reset(instance); }
+
+    std::vector<Node> Ruin(const Instance &instance, AlkaidSolution &solution,
+                           RouteContext &context, Random &random) const {
+      return config_.ruin_method->Ruin(instance, solution, context, random);
+    }
+
+  private:
+    const AlkaidConfig &config_;
+  };
+
+  // Calls the operators, the acceptance rule and the ruin method with qualified names of the types
+  // fixed at compile time, which bypasses the virtual dispatch. The config must hold exactly these
+  // types in the same order.
+  template <class InterOperators, class IntraOperators, class AcceptanceRuleType,
+            class RuinMethodType>
+  class StaticPipeline;
+
+  template <class... InterOperatorTypes, class... IntraOperatorTypes, class AcceptanceRuleType,
+            class RuinMethodType>
+  class StaticPipeline<TypeList<InterOperatorTypes...>, TypeList<IntraOperatorTypes...>,
+                       AcceptanceRuleType, RuinMethodType> {
+  public:
+    static_assert(sizeof...(InterOperatorTypes) > 0 && sizeof...(IntraOperatorTypes) > 0,
+                  "A static pipeline needs inter and intra operators.");
+
+    explicit StaticPipeline(const AlkaidConfig &config)
+        : inter_operators_(Cast<InterOperatorTypes...>(
+            config.inter_operators, std::index_sequence_for<InterOperatorTypes...>{})),
+          intra_operators_(Cast<IntraOperatorTypes...>(
+              config.intra_operators, std::index_sequence_for<IntraOperatorTypes...>{})),
+          acceptance_rule_(config.acceptance_rule),
+          ruin_method_(Cast<RuinMethodType>(config.ruin_method.get())) {}
+
+    int NumInterOperators() const { return sizeof...(InterOperatorTypes); }
+    int NumIntraOperators() const { return sizeof...(IntraOperatorTypes); }
+
+    std::vector<Node> Inter(int index, const Instance &instance, AlkaidSolution &solution,
+                            RouteContext &context, Random &random, CacheMap &cache_map) const {
+      return Visit(inter_operators_, index, [&](auto *inter_operator) {
+        using Type = std::remove_cv_t<std::remove_pointer_t<decltype(inter_operator)>>;
+        return inter_operator->Type::operator()(instance, solution, context, random, cache_map);
+      });
+    }
+
+    bool Intra(int index, const Instance &instance, Node route_index, AlkaidSolution &solution,
+               RouteContext &context, Random &random) const {
+      return Visit(intra_operators_, index, [&](auto *intra_operator) {
+        using Type = std::remove_cv_t<std::remove_pointer_t<decltype(intra_operator)>>;
+        return intra_operator->Type::operator()(instance, route_index, solution, context, random);
+      });
+    }
+
+    bool IsExact(int index, Node num_nodes) const {
+      return Visit(intra_operators_, index, [&](auto *intra_operator) {
+        using Type = std::remove_cv_t<std::remove_pointer_t<decltype(intra_operator)>>;
+        return intra_operator->Type::IsExact(num_nodes);
+      });
+    }
+
+    std::unique_ptr<acceptance_rule::AcceptanceRule> MakeAcceptanceRule() const {
+      auto acceptance_rule = acceptance_rule_();
+      Cast<AcceptanceRuleType>(acceptance_rule.get());
+      return acceptance_rule;
+    }
+
+    bool Accept(acceptance_rule::AcceptanceRule &acceptance_rule, int old_value, int new_value,
+                Random &random) const {
+      return static_cast<AcceptanceRuleType &>(acceptance_rule)
+          .AcceptanceRuleType::Accept(old_value, new_value, random);
+    }
+
+    void ResetRuin(const Instance &instance) const {
+      ruin_method_->RuinMethodType::Reset(instance);
+    }
+
+    std::vector<Node> Ruin(const Instance &instance, AlkaidSolution &solution,
+                           RouteContext &context, Random &random) const {
+      return ruin_method_->RuinMethodType::Ruin(instance, solution, context, random);
+    }
+
+  private:
+    template <class Type, class Base> static Type *Cast(Base *object) {
+      if (object == nullptr || typeid(*object) != typeid(Type)) {
+        throw std::invalid_argument("Config does not match the static solver.");
+      }
+      return static_cast<Type *>(object);
+    }
+
+    template <class... Types, class Base, size_t... indices>
+    static std::tuple<const Types *...> Cast(const std::vector<std::unique_ptr<Base>> &objects,
+                                             std::index_sequence<indices...>) {
+      if (objects.size() != sizeof...(Types)) {
+        throw std::invalid_argument("Config does not match the static solver.");
+      }
+      return {Cast<const Types>(static_cast<const Base *>(objects[indices].get()))...};
+    }
+
+    // Calls func with the element at a run-time index. The comparisons are unrolled at compile
+    // time, so the call inside func is direct.
+    template <size_t index = 0, class Tuple, class Func>
+    static auto Visit(const Tuple &tuple, int target, const Func &func) {
+      if constexpr (index + 1 < std::tuple_size_v<Tuple>) {
+        if (target != static_cast<int>(index)) {
+          return Visit<index + 1>(tuple, target, func);
+        }
+      }
+      return func(std::get<index>(tuple));
+    }
+
+    std::tuple<const InterOperatorTypes *...> inter_operators_;
+    std::tuple<const IntraOperatorTypes *...> intra_operators_;
+    const std::function<std::unique_ptr<acceptance_rule::AcceptanceRule>()> &acceptance_rule_;
+    RuinMethodType *ruin_method_;
+  };
+}  // namespace alkaidsd
@@ -17,6 +17,8 @@ namespace alkaidsd {
 
     float NextFloat() { return (NextInt() >> 8u) * kFloatMultiplier; }
 
+    uint32_t NextSeed() { return NextInt(); }
+
     template <class RandomIt> void Shuffle(RandomIt first, RandomIt last) {
       typename std::iterator_traits<RandomIt>::difference_type i, n;
       n = last - first;
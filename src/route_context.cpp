@@ -1,8 +1,12 @@
 #include "route_context.h"
 
+#include <algorithm>
+
 namespace alkaidsd {
   void RouteContext::CalcRouteContext(const AlkaidSolution &solution) {
     routes_.clear();
+    active_routes_.clear();
+    free_routes_.clear();
     for (Node node_index : solution.NodeIndices()) {
       if (solution.Predecessor(node_index) == 0) {
         AddRoute(node_index, node_index, 0);
@@ -12,6 +16,17 @@ namespace alkaidsd {
     for (Node route_index = 0; route_index < NumRoutes(); ++route_index) {
       UpdateRouteContext(solution, route_index, 0);
     }
+    std::fill(first_nodes_.begin(), first_nodes_.end(), 0);
+    next_nodes_.resize(solution.MaxNodeIndex() + 1);
+    auto &&node_indices = solution.NodeIndices();
+    for (auto it = node_indices.rbegin(); it != node_indices.rend(); ++it) {
+      Node customer = solution.Customer(*it);
+      if (first_nodes_.size() <= static_cast<size_t>(customer)) {
+        first_nodes_.resize(customer + 1);
+      }
+      next_nodes_[*it] = first_nodes_[customer];
+      first_nodes_[customer] = *it;
+    }
   }
 
   void RouteContext::UpdateRouteContext(const AlkaidSolution &solution, Node route_index,
@@ -28,8 +43,4 @@ namespace alkaidsd {
     routes_[route_index].tail = predecessor;
     routes_[route_index].load = load;
   }
-
-  void RouteContext::MoveRouteContext(Node dest_route_index, Node src_route_index) {
-    routes_[dest_route_index] = routes_[src_route_index];
-  }
 }  // namespace alkaidsd
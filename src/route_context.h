@@ -12,24 +12,53 @@ namespace alkaidsd {
     Node Tail(Node route_index) const { return routes_[route_index].tail; }
     int Load(Node route_index) const { return routes_[route_index].load; }
     int PreLoad(Node node_index) const { return pre_loads_[node_index]; }
+    // The nodes serving a customer, as a list linked in the order of the node indices. Built by
+    // CalcRouteContext and not maintained by later changes.
+    Node FirstNode(Node customer) const { return first_nodes_[customer]; }
+    Node NextNode(Node node_index) const { return next_nodes_[node_index]; }
     void SetHead(Node route_index, Node head) { routes_[route_index].head = head; }
     void AddLoad(Node route_index, int load) { routes_[route_index].load += load; }
+    // Route indices are stable slots: removed routes leave a hole that the next AddRoute reuses,
+    // so NumRoutes() is the number of slots and ActiveRoutes() lists the occupied ones.
     Node NumRoutes() const { return routes_.size(); }
-    void SetNumRoutes(Node num_routes) { routes_.resize(num_routes); }
-    void AddRoute(Node head, Node tail, int load) {
-      routes_.emplace_back(RouteData{head, tail, load});
+    const std::vector<Node> &ActiveRoutes() const { return active_routes_; }
+    Node AddRoute(Node head, Node tail, int load) {
+      Node route_index;
+      if (free_routes_.empty()) {
+        route_index = routes_.size();
+        routes_.emplace_back();
+      } else {
+        route_index = free_routes_.back();
+        free_routes_.pop_back();
+      }
+      routes_[route_index] = {head, tail, load, static_cast<Node>(active_routes_.size())};
+      active_routes_.push_back(route_index);
+      return route_index;
+    }
+    void RemoveRoute(Node route_index) {
+      Node position = routes_[route_index].position;
+      Node last_route = active_routes_.back();
+      routes_[last_route].position = position;
+      active_routes_[position] = last_route;
+      active_routes_.pop_back();
+      routes_[route_index] = {0, 0, 0, 0};
+      free_routes_.push_back(route_index);
     }
     void CalcRouteContext(const AlkaidSolution &solution);
     void UpdateRouteContext(const AlkaidSolution &solution, Node route_index, Node predecessor);
-    void MoveRouteContext(Node dest_route_index, Node src_route_index);
 
   private:
     struct RouteData {
       Node head;
       Node tail;
       int load;
+      Node position;
     };
     std::vector<RouteData> routes_;
+    std::vector<Node> active_routes_;
+    std::vector<Node> free_routes_;
     std::vector<int> pre_loads_;
+    std::vector<Node> first_nodes_;
+    std::vector<Node> next_nodes_;
   };
 }  // namespace alkaidsd
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <alkaidsd/instance.h>
+#include <alkaidsd/solution.h>
+
+#include <cstdint>
+#include <unordered_set>
+
+namespace alkaidsd {
+  // Remembers the routes, by a hash of their customer and load sequence, that are known to be
+  // locally optimal under the configured intra-operators. The number of nodes is kept with the
+  // hash, so that a collision also needs routes of the same length.
+  class RouteMemo {
+  public:
+    struct Signature {
+      uint64_t hash;
+      Node num_nodes;
+
+      bool operator==(const Signature &other) const {
+        return hash == other.hash && num_nodes == other.num_nodes;
+      }
+    };
+
+    static Signature Sign(const AlkaidSolution &solution, Node head) {
+      Signature signature{0x9e3779b97f4a7c15u, 0};
+      for (Node node_index = head; node_index; node_index = solution.Successor(node_index)) {
+        signature.hash = Mix(signature.hash ^ static_cast<uint64_t>(solution.Customer(node_index)));
+        signature.hash = Mix(signature.hash ^ static_cast<uint64_t>(solution.Load(node_index)));
+        ++signature.num_nodes;
+      }
+      return signature;
+    }
+    bool Contains(const Signature &signature) const { return signatures_.count(signature) != 0; }
+    void Insert(const Signature &signature) {
+      if (signatures_.size() >= kMaxSignatures) {
+        signatures_.clear();
+      }
+      signatures_.insert(signature);
+    }
+
+  private:
+    struct Hash {
+      size_t operator()(const Signature &signature) const {
+        return static_cast<size_t>(signature.hash);
+      }
+    };
+
+    static constexpr size_t kMaxSignatures = 1 << 20;
+
+    static uint64_t Mix(uint64_t x) {
+      x = (x ^ (x >> 30u)) * 0xbf58476d1ce4e5b9u;
+      x = (x ^ (x >> 27u)) * 0x94d049bb133111ebu;
+      return x ^ (x >> 31u);
+    }
+
+    std::unordered_set<Signature, Hash> signatures_;
+  };
+}  // namespace alkaidsd
@@ -2,7 +2,7 @@
 
 #include <algorithm>
 #include <numeric>
-#include <set>
+#include <tuple>
 #include <vector>
 
 #include "random.h"
@@ -23,6 +23,10 @@ namespace alkaidsd::ruin_method {
     return customers;
   }
 
+  // The adjacency lists keep this many nearest customers per customer to ruin on average. Walks
+  // rarely get past them, and sort the farther customers when they do.
+  constexpr int kNeighborsPerRuinedCustomer = 2;
+
   SisrsRuin::SisrsRuin(int average_customers, int max_length, double split_rate,
                        double preserved_probability)
       : average_customers_(average_customers),
@@ -32,50 +36,56 @@ namespace alkaidsd::ruin_method {
 
   std::vector<Node> SisrsRuin::Ruin(const Instance &instance, AlkaidSolution &solution,
                                     RouteContext &context, Random &random) {
+    if (num_customers_ != instance.num_customers) {
+      Reset(instance);
+    }
     double average_length = static_cast<double>(instance.num_customers - 1) / context.NumRoutes();
     double max_length = std::min(static_cast<double>(max_length_), average_length);
     double max_strings = 4.0 * average_customers_ / (1 + max_length_) - 1;
     size_t num_strings = static_cast<size_t>(random.NextFloat() * max_strings) + 1;
     int customer_seed = random.NextInt(1, instance.num_customers - 1);
-    std::vector<Node> node_indices(solution.NodeIndices());
-    auto &&seed_distances = instance.distance_matrix[customer_seed];
-    std::stable_sort(node_indices.begin(), node_indices.end(), [&](Node lhs, Node rhs) {
-      return seed_distances[solution.Customer(lhs)] < seed_distances[solution.Customer(rhs)];
-    });
-    std::set<Node> visited_heads;
+    const Node *neighbors = neighbors_.data() + static_cast<size_t>(customer_seed) * num_neighbors_;
+    std::vector<Node> far_neighbors;
+    std::vector<Node> visited_heads;
     std::vector<Node> route;
     std::vector<Node> customer_indices;
-    for (Node node_index : node_indices) {
-      if (visited_heads.size() >= num_strings) {
-        break;
+    for (Node i = 0; i + 1 < instance.num_customers && visited_heads.size() < num_strings; ++i) {
+      if (i == num_neighbors_) {
+        SortFarNeighbors(instance, customer_seed, far_neighbors);
       }
-      int position;
-      int head = GetRouteHead(solution, node_index, position);
-      if (!visited_heads.insert(head).second) {
-        continue;
-      }
-      GetRoute(solution, head, route);
-      int route_length = static_cast<int>(route.size());
-      double max_ruin_length = std::min(static_cast<double>(route_length), max_length);
-      int ruin_length = static_cast<int>(random.NextFloat() * max_ruin_length) + 1;
-      int num_preserved = 0;
-      int preserved_start_position = -1;
-      if (ruin_length >= 2 && ruin_length < route_length && random.NextFloat() < split_rate_) {
-        while (ruin_length < route_length) {
-          if (random.NextFloat() < preserved_probability_) {
-            break;
+      Node neighbor = i < num_neighbors_ ? neighbors[i] : far_neighbors[i - num_neighbors_];
+      for (Node node_index = context.FirstNode(neighbor);
+           node_index && visited_heads.size() < num_strings;
+           node_index = context.NextNode(node_index)) {
+        int position;
+        Node head = GetRouteHead(solution, node_index, position);
+        if (std::find(visited_heads.begin(), visited_heads.end(), head) != visited_heads.end()) {
+          continue;
+        }
+        visited_heads.emplace_back(head);
+        GetRoute(solution, head, route);
+        int route_length = static_cast<int>(route.size());
+        double max_ruin_length = std::min(static_cast<double>(route_length), max_length);
+        int ruin_length = static_cast<int>(random.NextFloat() * max_ruin_length) + 1;
+        int num_preserved = 0;
+        int preserved_start_position = -1;
+        if (ruin_length >= 2 && ruin_length < route_length && random.NextFloat() < split_rate_) {
+          while (ruin_length < route_length) {
+            if (random.NextFloat() < preserved_probability_) {
+              break;
+            }
+            ++num_preserved;
+            ++ruin_length;
           }
-          ++num_preserved;
-          ++ruin_length;
+          preserved_start_position = random.NextInt(1, ruin_length - num_preserved - 1);
         }
-        preserved_start_position = random.NextInt(1, ruin_length - num_preserved - 1);
-      }
-      int min_start_position = std::max(0, position - ruin_length + 1);
-      int max_start_position = std::min(route_length - ruin_length, position);
-      int start_position = random.NextInt(min_start_position, max_start_position);
-      for (int j = 0; j < ruin_length; ++j) {
-        if (j < preserved_start_position || j >= preserved_start_position + num_preserved) {
-          customer_indices.emplace_back(solution.Customer(route[start_position + j]));
+        int min_start_position = std::max(0, position - ruin_length + 1);
+        int max_start_position = std::min(route_length - ruin_length, position);
+        int start_position = random.NextInt(min_start_position, max_start_position);
+        for (int j = 0; j < ruin_length; ++j) {
+          if (j < preserved_start_position || j >= preserved_start_position + num_preserved) {
+            customer_indices.emplace_back(solution.Customer(route[start_position + j]));
+          }
         }
       }
     }
@@ -86,6 +96,42 @@ namespace alkaidsd::ruin_method {
     return customer_indices;
   }
 
+  void SisrsRuin::Reset(const Instance &instance) {
+    Node num_customers = instance.num_customers;
+    num_customers_ = num_customers;
+    num_neighbors_ = static_cast<Node>(std::min(
+        num_customers - 1, std::max(1, kNeighborsPerRuinedCustomer * average_customers_)));
+    neighbors_.resize(static_cast<size_t>(num_customers) * std::max<Node>(num_neighbors_, 0));
+    std::vector<Node> customers(std::max(num_customers - 1, 0));
+    for (Node source = 1; source < num_customers; ++source) {
+      auto &&distances = instance.distance_matrix[source];
+      std::iota(customers.begin(), customers.end(), 1);
+      std::partial_sort(customers.begin(), customers.begin() + num_neighbors_, customers.end(),
+                        [&](Node lhs, Node rhs) {
+                          return std::tie(distances[lhs], lhs) < std::tie(distances[rhs], rhs);
+                        });
+      std::copy(customers.begin(), customers.begin() + num_neighbors_,
+                neighbors_.begin() + static_cast<size_t>(source) * num_neighbors_);
+    }
+  }
+
+  // Sorts the customers that are not in the adjacency list of customer by their distance to it.
+  void SisrsRuin::SortFarNeighbors(const Instance &instance, Node customer,
+                                   std::vector<Node> &neighbors) const {
+    auto &&distances = instance.distance_matrix[customer];
+    auto closer = [&](Node lhs, Node rhs) {
+      return std::tie(distances[lhs], lhs) < std::tie(distances[rhs], rhs);
+    };
+    Node farthest = neighbors_[static_cast<size_t>(customer) * num_neighbors_ + num_neighbors_ - 1];
+    neighbors.clear();
+    for (Node other = 1; other < instance.num_customers; ++other) {
+      if (closer(farthest, other)) {
+        neighbors.push_back(other);
+      }
+    }
+    std::sort(neighbors.begin(), neighbors.end(), closer);
+  }
+
   Node SisrsRuin::GetRouteHead(AlkaidSolution &solution, Node node_index, int &position) {
     position = 0;
     while (true) {
@@ -1,81 +1,145 @@
 #include <alkaidsd/solver.h>
 
 #include <algorithm>
+#include <cassert>
 #include <chrono>
 #include <limits>
 #include <numeric>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include "cache.h"
 #include "construction.h"
+#include "customer_aggregation.h"
+#include "direct_trips.h"
+#include "incumbent_board.h"
+#include "operator_selector.h"
+#include "pipeline.h"
 #include "repair.h"
+#include "route_memo.h"
+#include "speculative_descent.h"
 #include "split_reinsertion.h"
+#include "thread_pool.h"
 #include "utils.h"
 
 namespace alkaidsd {
-  void IntraRouteSearch(const Instance &instance, const AlkaidConfig &config, Node route_index,
-                        AlkaidSolution &solution, RouteContext &context, Random &random) {
+  template <class Pipeline>
+  void IntraRouteSearch(const Instance &instance, const Pipeline &pipeline, Node route_index,
+                        AlkaidSolution &solution, RouteContext &context, Random &random,
+                        RouteMemo &route_memo, OperatorSelector &selector, Statistics &statistics) {
+    if (route_memo.Contains(RouteMemo::Sign(solution, context.Head(route_index)))) {
+      return;
+    }
     Repair(instance, route_index, solution, context);
-    std::vector<Node> intra_neighborhoods(config.intra_operators.size());
-    std::iota(intra_neighborhoods.begin(), intra_neighborhoods.end(), 0);
+    Node num_nodes = 0;
+    for (Node node_index = context.Head(route_index); node_index;
+         node_index = solution.Successor(node_index)) {
+      ++num_nodes;
+    }
+    // An exact operator solves the route in one call, so the other operators are not needed.
+    int exact = 0;
+    while (exact < pipeline.NumIntraOperators() && !pipeline.IsExact(exact, num_nodes)) {
+      ++exact;
+    }
+    std::vector<int> intra_neighborhoods;
     while (true) {
-      random.Shuffle(intra_neighborhoods.begin(), intra_neighborhoods.end());
+      if (exact < pipeline.NumIntraOperators()) {
+        intra_neighborhoods.assign(1, exact);
+      } else {
+        selector.Order(intra_neighborhoods, random);
+      }
       bool improved = false;
-      for (Node neighborhood : intra_neighborhoods) {
-        improved = (*config.intra_operators[neighborhood])(instance, route_index, solution, context,
-                                                           random);
+      for (int neighborhood : intra_neighborhoods) {
+        auto &operator_statistics = statistics.intra_operators[neighborhood];
+        ++operator_statistics.num_calls;
+        Node head = context.Head(route_index);
+        int cost = selector.Adaptive() ? CalcRouteCost(instance, solution, head) : 0;
+        auto start_time = OperatorSelector::Clock::now();
+        improved = pipeline.Intra(neighborhood, instance, route_index, solution, context, random);
+        if (selector.Adaptive()) {
+          selector.Reward(neighborhood,
+                          cost - CalcRouteCost(instance, solution, context.Head(route_index)),
+                          start_time);
+        }
         if (improved) {
+          ++operator_statistics.num_improvements;
           break;
         }
       }
-      if (!improved) {
+      if (!improved || exact < pipeline.NumIntraOperators()) {
         break;
       }
     }
+    route_memo.Insert(RouteMemo::Sign(solution, context.Head(route_index)));
   }
 
+  template <class Pipeline>
   void RandomizedVariableNeighborhoodDescent(const Instance &instance, const AlkaidConfig &config,
-                                             AlkaidSolution &solution, RouteContext &context,
-                                             Random &random, CacheMap &cache_map) {
+                                             const Pipeline &pipeline, AlkaidSolution &solution,
+                                             RouteContext &context, Random &random,
+                                             CacheMap &cache_map, ThreadPool &thread_pool,
+                                             Statistics &statistics, RouteMemo &route_memo,
+                                             OperatorSelector &inter_selector,
+                                             OperatorSelector &intra_selector) {
     cache_map.Reset(solution, context);
+    cache_map.Warmup(instance, solution, context, random, thread_pool);
+    std::vector<int> route_costs;
+    if (inter_selector.Adaptive()) {
+      route_costs.resize(context.NumRoutes());
+      for (Node route_index : context.ActiveRoutes()) {
+        route_costs[route_index] = CalcRouteCost(instance, solution, context.Head(route_index));
+      }
+    }
+    auto commit = [&](const std::vector<Node> &routes) {
+      for (Node route_index : routes) {
+        cache_map.RemoveRoute(route_index);
+        if (context.Head(route_index)) {
+          context.UpdateRouteContext(solution, route_index, 0);
+          cache_map.AddRoute(route_index);
+          IntraRouteSearch(instance, pipeline, route_index, solution, context, random,
+                           route_memo, intra_selector, statistics);
+        } else {
+          context.RemoveRoute(route_index);
+        }
+        if (inter_selector.Adaptive()) {
+          route_costs[route_index] = CalcRouteCost(instance, solution, context.Head(route_index));
+        }
+      }
+    };
+    // The first descent creates the shared caches, so it always runs sequentially.
+    if (config.descent_mode != kSequentialDescent && !cache_map.Empty()) {
+      SpeculativeDescent(instance, config, pipeline, solution, context, random, cache_map,
+                         thread_pool, statistics, inter_selector, commit);
+      cache_map.Save(solution, context);
+      return;
+    }
+    std::vector<int> inter_neighborhoods;
     while (true) {
-      std::vector<int> inter_neighborhoods(config.inter_operators.size());
-      std::iota(inter_neighborhoods.begin(), inter_neighborhoods.end(), 0);
-      random.Shuffle(inter_neighborhoods.begin(), inter_neighborhoods.end());
+      inter_selector.Order(inter_neighborhoods, random);
       bool improved = false;
       for (int neighborhood : inter_neighborhoods) {
-        Node original_num_routes = context.NumRoutes();
-        auto routes = (*config.inter_operators[neighborhood])(instance, solution, context, random,
-                                                              cache_map);
-        if (!routes.empty()) {
-          std::sort(routes.begin(), routes.end());
-          improved = true;
-          std::vector<Node> heads;
+        auto &operator_statistics = statistics.inter_operators[neighborhood];
+        ++operator_statistics.num_calls;
+        auto start_time = OperatorSelector::Clock::now();
+        std::vector<Node> routes;
+        {
+          CacheMap::StatisticsScope statistics_scope(
+              cache_map, config.collect_statistics ? &operator_statistics : nullptr);
+          routes = pipeline.Inter(neighborhood, instance, solution, context, random, cache_map);
+        }
+        if (inter_selector.Adaptive()) {
+          int improvement = 0;
           for (Node route_index : routes) {
-            Node head = context.Head(route_index);
-            if (head) {
-              heads.emplace_back(head);
-            }
-            if (route_index < original_num_routes) {
-              cache_map.RemoveRoute(route_index);
-            }
-          }
-          Node num_routes = 0;
-          for (Node route_index = 0; route_index < context.NumRoutes(); ++route_index) {
-            if (std::find(routes.begin(), routes.end(), route_index) == routes.end()) {
-              context.MoveRouteContext(num_routes, route_index);
-              cache_map.MoveRoute(num_routes, route_index);
-              ++num_routes;
-            }
+            improvement += route_costs[route_index]
+                           - CalcRouteCost(instance, solution, context.Head(route_index));
           }
-          for (Node head : heads) {
-            context.SetHead(num_routes, head);
-            context.UpdateRouteContext(solution, num_routes, 0);
-            cache_map.AddRoute(num_routes);
-            IntraRouteSearch(instance, config, num_routes, solution, context, random);
-            ++num_routes;
-          }
-          context.SetNumRoutes(num_routes);
+          inter_selector.Reward(neighborhood, improvement, start_time);
+        }
+        if (!routes.empty()) {
+          ++operator_statistics.num_improvements;
+          improved = true;
+          commit(routes);
           break;
         }
       }
@@ -86,10 +150,12 @@ namespace alkaidsd {
     cache_map.Save(solution, context);
   }
 
-  void Perturb(const Instance &instance, const AlkaidConfig &config, AlkaidSolution &solution,
-               RouteContext &context, Random &random) {
+  template <class Pipeline>
+  void Perturb(const Instance &instance, const AlkaidConfig &config, const Pipeline &pipeline,
+               AlkaidSolution &solution, RouteContext &context, Random &random,
+               RouteCandidates &route_candidates, inter_operator::RouteArrays &route_arrays) {
     context.CalcRouteContext(solution);
-    std::vector<Node> customers = config.ruin_method->Ruin(instance, solution, context, random);
+    std::vector<Node> customers = pipeline.Ruin(instance, solution, context, random);
     config.sorter.Sort(instance, customers, random);
     for (Node customer : customers) {
       for (Node route_index = 0; route_index < context.NumRoutes(); ++route_index) {
@@ -108,10 +174,76 @@ namespace alkaidsd {
         }
       }
     }
+    route_candidates.Reset(solution, context);
+    route_arrays.Reset(solution, context);
     for (Node customer : customers) {
       SplitReinsertion(instance, customer, instance.demands[customer], config.blink_rate, solution,
-                       context, random);
+                       context, random, route_candidates, route_arrays);
+    }
+  }
+
+  void AddStatistics(std::vector<OperatorStatistics> &statistics,
+                     const std::vector<OperatorStatistics> &other) {
+    for (size_t i = 0; i < statistics.size(); ++i) {
+      statistics[i].num_calls += other[i].num_calls;
+      statistics[i].num_improvements += other[i].num_improvements;
+      statistics[i].num_cache_hits += other[i].num_cache_hits;
+      statistics[i].num_cache_misses += other[i].num_cache_misses;
+      statistics[i].num_cache_invalidations += other[i].num_cache_invalidations;
+      statistics[i].num_preprocesses += other[i].num_preprocesses;
+      statistics[i].num_evaluations += other[i].num_evaluations;
+      statistics[i].num_filtered_pairs += other[i].num_filtered_pairs;
+      statistics[i].weight += other[i].weight;
+    }
+  }
+
+  // Builds the candidates of a restart concurrently, each with its own random stream, caches and
+  // memo, improves each by one descent and returns the best. Nested parallel loops of the descent
+  // run serially on the worker of their candidate.
+  template <class Pipeline>
+  AlkaidSolution ConstructByRace(const Instance &instance, const AlkaidConfig &config,
+                                 const Pipeline &pipeline, const Constructor &constructor,
+                                 Random &random, ThreadPool &thread_pool,
+                                 Statistics &statistics) {
+    int num_candidates = config.num_restart_candidates;
+    std::vector<AlkaidSolution> solutions(num_candidates);
+    std::vector<int> objectives(num_candidates);
+    std::vector<Statistics> candidate_statistics(num_candidates);
+    for (auto &&candidate : candidate_statistics) {
+      candidate.inter_operators.assign(statistics.inter_operators.size(), {});
+      candidate.intra_operators.assign(statistics.intra_operators.size(), {});
+    }
+    uint32_t seed = random.NextSeed();
+    thread_pool.ParallelFor(num_candidates, [&](int k) {
+      Random candidate_random(seed + k);
+      RouteContext context;
+      CacheMap cache_map;
+      cache_map.SetThreadPool(thread_pool);
+      OperatorSelector inter_selector(config.inter_operators.size(), false,
+                                      config.selection_decay);
+      OperatorSelector intra_selector(config.intra_operators.size(), false,
+                                      config.selection_decay);
+      RouteMemo route_memo;
+      auto &solution = solutions[k];
+      solution = constructor.Construct(instance, candidate_random);
+      context.CalcRouteContext(solution);
+      for (Node i = 0; i < context.NumRoutes(); ++i) {
+        IntraRouteSearch(instance, pipeline, i, solution, context, candidate_random, route_memo,
+                         intra_selector, candidate_statistics[k]);
+      }
+      RandomizedVariableNeighborhoodDescent(instance, config, pipeline, solution, context,
+                                            candidate_random, cache_map, thread_pool,
+                                            candidate_statistics[k], route_memo, inter_selector,
+                                            intra_selector);
+      objectives[k] = solution.CalcObjective(instance);
+    });
+    for (auto &&candidate : candidate_statistics) {
+      AddStatistics(statistics.inter_operators, candidate.inter_operators);
+      AddStatistics(statistics.intra_operators, candidate.intra_operators);
     }
+    int best = static_cast<int>(std::min_element(objectives.begin(), objectives.end())
+                                - objectives.begin());
+    return std::move(solutions[best]);
   }
 
   double ElapsedTime(std::chrono::time_point<std::chrono::high_resolution_clock> start_time) {
@@ -120,33 +252,60 @@ namespace alkaidsd {
         .count();
   }
 
-  AlkaidSolution AlkaidSolver::Solve(const AlkaidConfig &config, const Instance &instance) {
-    if (config.listener != nullptr) {
-      config.listener->OnStart();
-    }
-    Random random(config.random_seed);
+  // Alternates constructions and iterated local searches until the time limit, with its own random
+  // stream, caches and selectors. The first construction runs even past the time limit, so that
+  // the loop always has a solution. Calls publish with each solution improving the best one of the
+  // loop, and poll once per iteration. Returns the best objective and fills in the statistics.
+  template <class Pipeline, class Publish, class Poll>
+  int RunRestartLoop(const Instance &instance, const AlkaidConfig &config,
+                     const Pipeline &pipeline, const Constructor &constructor, uint32_t seed,
+                     ThreadPool &thread_pool,
+                     std::chrono::time_point<std::chrono::high_resolution_clock> start_time,
+                     AlkaidSolution &best_solution, Statistics &statistics,
+                     const Publish &publish, const Poll &poll) {
+    Random random(seed);
     RouteContext context;
     CacheMap cache_map;
-    AlkaidSolution best_solution;
-    int best_objective = std::numeric_limits<int>::max();
-    auto start_time = std::chrono::high_resolution_clock::now();
+    cache_map.SetThreadPool(thread_pool);
+    statistics.inter_operators.resize(config.inter_operators.size());
+    statistics.intra_operators.resize(config.intra_operators.size());
+    OperatorSelector inter_selector(config.inter_operators.size(), config.adaptive_selection,
+                                    config.selection_decay);
+    OperatorSelector intra_selector(config.intra_operators.size(), config.adaptive_selection,
+                                    config.selection_decay);
+    RouteMemo route_memo;
+    RouteCandidates route_candidates(instance, config.reinsertion_neighbors);
+    inter_operator::RouteArrays route_arrays;
+    int best_objective = instance.num_customers > 1 ? std::numeric_limits<int>::max() : 0;
     const int kMaxStagnation = std::min(5000, static_cast<int>(instance.num_customers)
                                                   * static_cast<int>(CalcFleetLowerBound(instance)));
-    while (ElapsedTime(start_time) < config.time_limit) {
-      auto solution = Construct(instance, random);
+    while (instance.num_customers > 1
+           && (best_objective == std::numeric_limits<int>::max()
+               || ElapsedTime(start_time) < config.time_limit)) {
+      auto solution = config.num_restart_candidates > 1
+                          ? ConstructByRace(instance, config, pipeline, constructor, random,
+                                            thread_pool, statistics)
+                          : constructor.Construct(instance, random);
       int objective = solution.CalcObjective(instance);
+      if (objective < best_objective) {
+        best_objective = objective;
+        best_solution = solution;
+        publish(best_solution, best_objective);
+      }
       int iter_best_objective = objective;
       auto new_solution = solution;
-      auto acceptance_rule = config.acceptance_rule();
+      auto acceptance_rule = pipeline.MakeAcceptanceRule();
       int num_stagnation = 0;
       while (num_stagnation < kMaxStagnation && ElapsedTime(start_time) < config.time_limit) {
         ++num_stagnation;
         context.CalcRouteContext(new_solution);
         for (Node i = 0; i < context.NumRoutes(); ++i) {
-          IntraRouteSearch(instance, config, i, new_solution, context, random);
+          IntraRouteSearch(instance, pipeline, i, new_solution, context, random, route_memo,
+                           intra_selector, statistics);
         }
-        RandomizedVariableNeighborhoodDescent(instance, config, new_solution, context, random,
-                                              cache_map);
+        RandomizedVariableNeighborhoodDescent(instance, config, pipeline, new_solution, context,
+                                              random, cache_map, thread_pool, statistics,
+                                              route_memo, inter_selector, intra_selector);
         int new_objective = new_solution.CalcObjective(instance);
         if (new_objective < iter_best_objective) {
           num_stagnation = 0;
@@ -155,22 +314,139 @@ namespace alkaidsd {
         if (new_objective < best_objective) {
           best_objective = new_objective;
           best_solution = new_solution;
-          if (config.listener != nullptr) {
-            config.listener->OnUpdated(best_solution, best_objective);
-          }
+          publish(best_solution, best_objective);
         }
-        if (acceptance_rule->Accept(objective, new_objective, random)) {
+        poll();
+        if (pipeline.Accept(*acceptance_rule, objective, new_objective, random)) {
           objective = new_objective;
           solution = new_solution;
         } else {
           new_solution = solution;
         }
-        Perturb(instance, config, new_solution, context, random);
+        Perturb(instance, config, pipeline, new_solution, context, random, route_candidates,
+                route_arrays);
+      }
+    }
+    if (config.collect_statistics || config.adaptive_selection) {
+      for (size_t i = 0; i < config.inter_operators.size(); ++i) {
+        statistics.inter_operators[i].weight = inter_selector.Weights()[i];
+      }
+      for (size_t i = 0; i < config.intra_operators.size(); ++i) {
+        statistics.intra_operators[i].weight = intra_selector.Weights()[i];
+      }
+    }
+    return best_objective;
+  }
+
+  template <class Pipeline>
+  AlkaidSolution Solve(const AlkaidConfig &config, const Pipeline &pipeline,
+                       const Instance &original_instance) {
+    if (config.listener != nullptr) {
+      config.listener->OnStart();
+    }
+    CustomerAggregation customer_aggregation(original_instance);
+    DirectTrips direct_trips(customer_aggregation.Reduced());
+    const Instance &instance = direct_trips.Residual();
+    auto expand = [&](const AlkaidSolution &solution) {
+      return customer_aggregation.Expand(direct_trips.Expand(solution));
+    };
+    auto on_updated = [&](const AlkaidSolution &solution, int objective) {
+      if (config.listener != nullptr) {
+        config.listener->OnUpdated(expand(solution), objective + direct_trips.Cost());
+      }
+    };
+    Constructor constructor(instance, config.construction_methods);
+    // Before the restart loops start, so that the loops share the ruin method read-only.
+    pipeline.ResetRuin(instance);
+    Statistics statistics;
+    AlkaidSolution best_solution;
+    int best_objective;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    if (!config.multi_start || config.num_threads <= 1) {
+      ThreadPool thread_pool(config.num_threads);
+      best_objective
+          = RunRestartLoop(instance, config, pipeline, constructor, config.random_seed,
+                           thread_pool, start_time, best_solution, statistics, on_updated, [] {});
+    } else {
+      // Every thread runs its own restart loop with a serial thread pool and the seed offset by
+      // its index. The loops only share the board, which the first loop polls to call the
+      // listener, so the listener is called from a single thread. The other loops' improvements
+      // reach it at the first loop's next iteration.
+      int num_loops = config.num_threads;
+      ThreadPool thread_pool(num_loops);
+      IncumbentBoard board;
+      std::vector<AlkaidSolution> best_solutions(num_loops);
+      std::vector<int> best_objectives(num_loops);
+      std::vector<Statistics> loop_statistics(num_loops);
+      thread_pool.ParallelFor(num_loops, [&](int k) {
+        ThreadPool serial_thread_pool(1);
+        auto poll = [&] {
+          if (k == 0) {
+            board.Notify(on_updated);
+          }
+        };
+        auto publish = [&](const AlkaidSolution &solution, int objective) {
+          board.Publish(solution, objective);
+          poll();
+        };
+        best_objectives[k] = RunRestartLoop(instance, config, pipeline, constructor,
+                                            config.random_seed + k, serial_thread_pool,
+                                            start_time, best_solutions[k], loop_statistics[k],
+                                            publish, poll);
+      });
+      board.Notify(on_updated);
+      // Ties go to the lowest index, so the result does not depend on the timing of the loops.
+      int best = static_cast<int>(
+          std::min_element(best_objectives.begin(), best_objectives.end())
+          - best_objectives.begin());
+      best_solution = std::move(best_solutions[best]);
+      best_objective = best_objectives[best];
+      statistics = std::move(loop_statistics[0]);
+      for (int k = 1; k < num_loops; ++k) {
+        AddStatistics(statistics.inter_operators, loop_statistics[k].inter_operators);
+        AddStatistics(statistics.intra_operators, loop_statistics[k].intra_operators);
+      }
+      // The loops learn their weights separately, so the reported weights are their averages.
+      for (auto &&operators : {&statistics.inter_operators, &statistics.intra_operators}) {
+        for (auto &&operator_statistics : *operators) {
+          operator_statistics.weight /= num_loops;
+        }
       }
     }
+    if (best_objective == std::numeric_limits<int>::max()) {
+      throw std::logic_error("No restart loop produced a solution.");
+    }
+    best_solution = expand(best_solution);
+    best_objective += direct_trips.Cost();
+    assert(best_solution.CalcObjective(original_instance) == best_objective);
     if (config.listener != nullptr) {
+      if (config.collect_statistics || config.adaptive_selection) {
+        config.listener->OnStatistics(statistics);
+      }
       config.listener->OnEnd(best_solution, best_objective);
     }
     return best_solution;
   }
+
+  AlkaidSolution AlkaidSolver::Solve(const AlkaidConfig &config, const Instance &instance) {
+    return alkaidsd::Solve(config, DynamicPipeline(config), instance);
+  }
+
+  template <class InterOperators, class IntraOperators, class AcceptanceRuleType,
+            class RuinMethodType>
+  AlkaidSolution
+  AlkaidSolverT<InterOperators, IntraOperators, AcceptanceRuleType, RuinMethodType>::Solve(
+      const AlkaidConfig &config, const Instance &instance) {
+    return alkaidsd::Solve(
+        config,
+        StaticPipeline<InterOperators, IntraOperators, AcceptanceRuleType, RuinMethodType>(config),
+        instance);
+  }
+
+  template class AlkaidSolverT<
+      TypeList<inter_operator::Relocate, inter_operator::Swap<2, 0>, inter_operator::Swap<2, 1>,
+               inter_operator::Swap<2, 2>, inter_operator::Cross, inter_operator::SwapStar,
+               inter_operator::SdSwapStar>,
+      TypeList<intra_operator::Exchange, intra_operator::OrOpt<1>>,
+      acceptance_rule::LateAcceptanceHillClimbing, ruin_method::SisrsRuin>;
 }  // namespace alkaidsd
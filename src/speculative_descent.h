@@ -0,0 +1,89 @@
+#pragma once
+
+#include <alkaidsd/config.h>
+#include <alkaidsd/instance.h>
+#include <alkaidsd/solution.h>
+#include <alkaidsd/statistics.h>
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include "cache.h"
+#include "operator_selector.h"
+#include "random.h"
+#include "route_context.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+namespace alkaidsd {
+  // Runs every inter-operator on its own copy of the solution on the thread pool and applies one
+  // of the improving moves, until none improves. The pair caches the other operators computed
+  // stay valid for the routes the applied move does not touch. The operators apply their moves
+  // themselves, so each needs a copy; the copies keep their buffers across steps, which makes
+  // copying a small fraction of the evaluation that every operator runs anyway. The operators must
+  // have created their caches in the cache map already, so that the warmup prepares them
+  // deterministically before the operators run.
+  template <class Pipeline, class Commit>
+  void SpeculativeDescent(const Instance &instance, const AlkaidConfig &config,
+                          const Pipeline &pipeline, AlkaidSolution &solution,
+                          RouteContext &context, Random &random, CacheMap &cache_map,
+                          ThreadPool &thread_pool, Statistics &statistics,
+                          OperatorSelector &inter_selector, const Commit &commit) {
+    int num_operators = pipeline.NumInterOperators();
+    std::vector<AlkaidSolution> solutions(num_operators);
+    std::vector<RouteContext> contexts(num_operators);
+    std::vector<std::vector<Node>> routes(num_operators);
+    std::vector<int> improvements(num_operators);
+    std::vector<double> microseconds(num_operators);
+    std::vector<int> inter_neighborhoods;
+    while (true) {
+      cache_map.Warmup(instance, solution, context, random, thread_pool);
+      uint32_t seed = random.NextSeed();
+      thread_pool.ParallelFor(num_operators, [&](int k) {
+        auto start_time = OperatorSelector::Clock::now();
+        solutions[k] = solution;
+        contexts[k] = context;
+        Random operator_random(seed + k);
+        CacheMap::StatisticsScope statistics_scope(
+            cache_map, config.collect_statistics ? &statistics.inter_operators[k] : nullptr);
+        routes[k] = pipeline.Inter(k, instance, solutions[k], contexts[k], operator_random,
+                                   cache_map);
+        improvements[k] = 0;
+        for (Node route_index : routes[k]) {
+          improvements[k] += CalcRouteCost(instance, solution, context.Head(route_index))
+                             - CalcRouteCost(instance, solutions[k], contexts[k].Head(route_index));
+        }
+        microseconds[k] = std::chrono::duration<double, std::micro>(
+                              OperatorSelector::Clock::now() - start_time)
+                              .count();
+      });
+      inter_selector.Order(inter_neighborhoods, random);
+      int chosen = -1;
+      for (int neighborhood : inter_neighborhoods) {
+        if (routes[neighborhood].empty()) {
+          continue;
+        }
+        if (chosen == -1
+            || (config.descent_mode == kSpeculativeBest
+                && improvements[neighborhood] > improvements[chosen])) {
+          chosen = neighborhood;
+        }
+        if (config.descent_mode == kSpeculativeFirst) {
+          break;
+        }
+      }
+      for (int k = 0; k < num_operators; ++k) {
+        ++statistics.inter_operators[k].num_calls;
+        inter_selector.Reward(k, improvements[k], microseconds[k]);
+      }
+      if (chosen == -1) {
+        break;
+      }
+      ++statistics.inter_operators[chosen].num_improvements;
+      std::swap(solution, solutions[chosen]);
+      std::swap(context, contexts[chosen]);
+      commit(routes[chosen]);
+    }
+  }
+}  // namespace alkaidsd
@@ -1,6 +1,7 @@
 #include "split_reinsertion.h"
 
 #include <algorithm>
+#include <tuple>
 #include <vector>
 
 #include "utils.h"
@@ -13,25 +14,129 @@ namespace alkaidsd {
         : insertion(insertion), residual(residual) {}
   };
 
-  void SplitReinsertion(const Instance &instance, Node customer, int demand, double blink_rate,
-                        AlkaidSolution &solution, RouteContext &context, Random &random) {
-    auto func = [&](Node predecessor, Node successor, Node customer) {
-      Node pre_customer = solution.Customer(predecessor);
-      Node suc_customer = solution.Customer(successor);
-      return instance.distance_matrix[customer][pre_customer]
-             + instance.distance_matrix[customer][suc_customer]
-             - instance.distance_matrix[pre_customer][suc_customer];
+  RouteCandidates::RouteCandidates(const Instance &instance, Node num_neighbors)
+      : num_neighbors_(std::max(0, std::min<int>(num_neighbors, instance.num_customers - 2))) {
+    neighbors_.resize(static_cast<size_t>(instance.num_customers) * num_neighbors_);
+    std::vector<Node> customers;
+    for (Node customer = 1; customer < instance.num_customers && num_neighbors_ > 0; ++customer) {
+      customers.clear();
+      for (Node other = 1; other < instance.num_customers; ++other) {
+        if (other != customer) {
+          customers.emplace_back(other);
+        }
+      }
+      auto &&distances = instance.distance_matrix[customer];
+      std::partial_sort(customers.begin(), customers.begin() + num_neighbors_, customers.end(),
+                        [&](Node lhs, Node rhs) {
+                          return std::tie(distances[lhs], lhs) < std::tie(distances[rhs], rhs);
+                        });
+      std::copy(customers.begin(), customers.begin() + num_neighbors_,
+                neighbors_.begin() + static_cast<size_t>(customer) * num_neighbors_);
+    }
+    first_nodes_.resize(instance.num_customers);
+  }
+
+  void RouteCandidates::Reset(const AlkaidSolution &solution, const RouteContext &context) {
+    if (!Enabled()) {
+      return;
+    }
+    std::fill(first_nodes_.begin(), first_nodes_.end(), 0);
+    next_nodes_.resize(solution.MaxNodeIndex() + 1);
+    node_routes_.resize(solution.MaxNodeIndex() + 1);
+    for (Node route_index = 0; route_index < context.NumRoutes(); ++route_index) {
+      for (Node node_index = context.Head(route_index); node_index;
+           node_index = solution.Successor(node_index)) {
+        AddNode(node_index, solution.Customer(node_index), route_index);
+      }
+    }
+  }
+
+  void RouteCandidates::AddNode(Node node_index, Node customer, Node route_index) {
+    if (next_nodes_.size() <= static_cast<size_t>(node_index)) {
+      next_nodes_.resize(node_index + 1);
+      node_routes_.resize(node_index + 1);
+    }
+    next_nodes_[node_index] = first_nodes_[customer];
+    node_routes_[node_index] = route_index;
+    first_nodes_[customer] = node_index;
+  }
+
+  void RouteCandidates::Collect(const Instance &instance, Node customer,
+                                const RouteContext &context, std::vector<Node> &routes) {
+    route_stamps_.resize(context.NumRoutes());
+    ++stamp_;
+    routes.clear();
+    auto add = [&](Node route_index) {
+      if (route_stamps_[route_index] != stamp_) {
+        route_stamps_[route_index] = stamp_;
+        routes.emplace_back(route_index);
+      }
     };
+    auto begin = neighbors_.begin() + static_cast<size_t>(customer) * num_neighbors_;
+    for (auto it = begin; it != begin + num_neighbors_; ++it) {
+      for (Node node_index = first_nodes_[*it]; node_index; node_index = next_nodes_[node_index]) {
+        add(node_routes_[node_index]);
+      }
+    }
+    Node spare_routes[kNumSpareRoutes];
+    int num_spare_routes = 0;
+    auto residual = [&](Node route_index) { return instance.capacity - context.Load(route_index); };
+    for (Node route_index = 0; route_index < context.NumRoutes(); ++route_index) {
+      if (residual(route_index) <= 0) {
+        continue;
+      }
+      int position = std::min(num_spare_routes, kNumSpareRoutes - 1);
+      if (num_spare_routes == kNumSpareRoutes
+          && residual(route_index) <= residual(spare_routes[position])) {
+        continue;
+      }
+      while (position > 0 && residual(route_index) > residual(spare_routes[position - 1])) {
+        spare_routes[position] = spare_routes[position - 1];
+        --position;
+      }
+      spare_routes[position] = route_index;
+      num_spare_routes = std::min(num_spare_routes + 1, kNumSpareRoutes);
+    }
+    for (int i = 0; i < num_spare_routes; ++i) {
+      add(spare_routes[i]);
+    }
+    std::sort(routes.begin(), routes.end());
+  }
+
+  void SplitReinsertion(const Instance &instance, Node customer, int demand, double blink_rate,
+                        AlkaidSolution &solution, RouteContext &context, Random &random,
+                        RouteCandidates &candidates, inter_operator::RouteArrays &route_arrays) {
+    auto &&distances = instance.distance_matrix[customer];
+    auto func
+        = [&](Node pre_customer, Node suc_customer, int length, [[maybe_unused]] Node customer) {
+            return distances[pre_customer] + distances[suc_customer] - length;
+          };
     std::vector<SplitReinsertionMove> moves;
     moves.reserve(context.NumRoutes());
     int sum_residual = 0;
-    for (Node route_index = 0; route_index < context.NumRoutes(); ++route_index) {
+    auto evaluate = [&](Node route_index) {
       int residual = std::min(demand, instance.capacity - context.Load(route_index));
       if (residual > 0) {
-        auto insertion = CalcBestInsertion(solution, func, context, route_index, customer, random);
+        auto insertion = CalcBestInsertionBatch(instance, solution, func, context, route_arrays,
+                                                route_index, customer, random);
         moves.emplace_back(insertion, residual);
         sum_residual += residual;
       }
+    };
+    if (candidates.Enabled()) {
+      std::vector<Node> routes;
+      candidates.Collect(instance, customer, context, routes);
+      for (Node route_index : routes) {
+        evaluate(route_index);
+      }
+    }
+    // Falls back to every route when the candidates cannot hold the demand.
+    if (sum_residual < demand) {
+      moves.clear();
+      sum_residual = 0;
+      for (Node route_index = 0; route_index < context.NumRoutes(); ++route_index) {
+        evaluate(route_index);
+      }
     }
     if (sum_residual < demand) {
       return;
@@ -52,7 +157,11 @@ namespace alkaidsd {
       if (move.insertion.predecessor == 0) {
         context.SetHead(move.insertion.route_index, node_index);
       }
+      if (candidates.Enabled()) {
+        candidates.AddNode(node_index, customer, move.insertion.route_index);
+      }
       context.UpdateRouteContext(solution, move.insertion.route_index, move.insertion.predecessor);
+      route_arrays.AddRoute(move.insertion.route_index);
       demand -= load;
       if (demand == 0) {
         break;
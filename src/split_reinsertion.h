@@ -3,11 +3,40 @@
 #include <alkaidsd/instance.h>
 #include <alkaidsd/solution.h>
 
+#include <vector>
+
+#include "inter_operator/route_arrays.h"
 #include "random.h"
 #include "route_context.h"
 
 namespace alkaidsd {
+  // The routes SplitReinsertion evaluates for a customer: those serving one of its nearest
+  // neighbors and the few with the most spare capacity. The route of every node is recorded by
+  // Reset and kept up to date as SplitReinsertion inserts nodes. Without neighbors every route is
+  // evaluated.
+  class RouteCandidates {
+  public:
+    RouteCandidates(const Instance &instance, Node num_neighbors);
+    bool Enabled() const { return num_neighbors_ > 0; }
+    void Reset(const AlkaidSolution &solution, const RouteContext &context);
+    void AddNode(Node node_index, Node customer, Node route_index);
+    void Collect(const Instance &instance, Node customer, const RouteContext &context,
+                 std::vector<Node> &routes);
+
+  private:
+    static constexpr int kNumSpareRoutes = 3;
+
+    Node num_neighbors_;
+    std::vector<Node> neighbors_;
+    std::vector<Node> first_nodes_;
+    std::vector<Node> next_nodes_;
+    std::vector<Node> node_routes_;
+    std::vector<int> route_stamps_;
+    int stamp_{};
+  };
+
   void SplitReinsertion(const Instance &instance, Node customer, int demand, double blink_rate,
-                        AlkaidSolution &solution, RouteContext &context, Random &random);
+                        AlkaidSolution &solution, RouteContext &context, Random &random,
+                        RouteCandidates &candidates, inter_operator::RouteArrays &route_arrays);
 
 }  // namespace alkaidsd
@@ -0,0 +1,76 @@
+#include "thread_pool.h"
+
+namespace alkaidsd {
+  ThreadPool::ThreadPool(int num_threads) {
+    for (int i = 1; i < num_threads; ++i) {
+      workers_.emplace_back(&ThreadPool::Work, this);
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    start_condition_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  void ThreadPool::ParallelFor(int n, const std::function<void(int)> &func) {
+    if (workers_.empty() || n <= 1 || running_.exchange(true)) {
+      for (int i = 0; i < n; ++i) {
+        func(i);
+      }
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      func_ = &func;
+      size_ = n;
+      next_ = 0;
+      num_active_ = static_cast<int>(workers_.size());
+      ++generation_;
+    }
+    start_condition_.notify_all();
+    Drain();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_condition_.wait(lock, [this] { return num_active_ == 0; });
+      func_ = nullptr;
+    }
+    running_ = false;
+  }
+
+  void ThreadPool::Work() {
+    uint64_t generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        start_condition_.wait(lock, [&] { return stopped_ || generation_ != generation; });
+        if (stopped_) {
+          return;
+        }
+        generation = generation_;
+      }
+      Drain();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--num_active_ == 0) {
+          done_condition_.notify_one();
+        }
+      }
+    }
+  }
+
+  void ThreadPool::Drain() {
+    while (true) {
+      int i = next_.fetch_add(1);
+      if (i >= size_) {
+        break;
+      }
+      (*func_)(i);
+    }
+  }
+}  // namespace alkaidsd
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace alkaidsd {
+  class ThreadPool {
+  public:
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    int NumThreads() const { return static_cast<int>(workers_.size()) + 1; }
+    // Calls func(i) for every i in [0, n) and returns when all calls are finished. The calling
+    // thread takes part in the work. Nested calls from inside func run serially.
+    void ParallelFor(int n, const std::function<void(int)> &func);
+
+  private:
+    void Work();
+    void Drain();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_condition_;
+    std::condition_variable done_condition_;
+    const std::function<void(int)> *func_{};
+    int size_{};
+    std::atomic<int> next_{};
+    std::atomic<bool> running_{};
+    int num_active_{};
+    uint64_t generation_{};
+    bool stopped_{};
+  };
+}  // namespace alkaidsd
@@ -4,6 +4,7 @@
 #include <alkaidsd/solution.h>
 
 #include "delta.h"
+#include "inter_operator/route_arrays.h"
 #include "route_context.h"
 
 namespace alkaidsd {
@@ -43,6 +44,48 @@ namespace alkaidsd {
     return best_insertion;
   }
 
+  // Same as CalcBestInsertion over the arrays of the route, with func taking the customers and the
+  // length of the edge instead of its nodes. The scan runs over contiguous arrays instead of
+  // following the links, and breaks ties like Delta::Update so that results do not change. The
+  // caller marks the routes it changes in route_arrays.
+  template <class Func>
+  auto CalcBestInsertionBatch(const Instance &instance, const AlkaidSolution &solution,
+                              const Func &func, const RouteContext &context,
+                              inter_operator::RouteArrays &route_arrays, Node route_index,
+                              Node customer, Random &random) {
+    auto &&route = route_arrays.Get(instance, solution, context, route_index);
+    const int *customers = route.customers.data();
+    const int *lengths = route.next.data();
+    int num_edges = route.Size() - 1;
+    auto best_cost = func(customers[0], customers[1], lengths[0], customer);
+    int best_position = 0;
+    int counter = 1;
+    for (int i = 1; i < num_edges; ++i) {
+      auto cost = func(customers[i], customers[i + 1], lengths[i], customer);
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_position = i;
+        counter = 1;
+      } else if (cost == best_cost && random.NextInt(1, ++counter) == 1) {
+        best_position = i;
+      }
+    }
+    return InsertionWithCost<decltype(best_cost)>{route.nodes[best_position],
+                                                  route.nodes[best_position + 1], route_index,
+                                                  Delta(best_cost, counter)};
+  }
+
+  inline int CalcRouteCost(const Instance &instance, const AlkaidSolution &solution, Node head) {
+    int cost = 0;
+    Node predecessor = 0;
+    for (Node node_index = head; node_index; node_index = solution.Successor(node_index)) {
+      cost += instance
+                  .distance_matrix[solution.Customer(predecessor)][solution.Customer(node_index)];
+      predecessor = node_index;
+    }
+    return cost + instance.distance_matrix[solution.Customer(predecessor)][0];
+  }
+
   inline Node CalcFleetLowerBound(const Instance &instance) {
     int sum_demands = 0;
     for (Node i = 1; i < instance.num_customers; ++i) {
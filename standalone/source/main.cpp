@@ -6,9 +6,14 @@
 #include <random>
 
 std::vector<std::unique_ptr<alkaidsd::inter_operator::InterOperator>> ParseInterOperators(
-    const std::vector<std::string> &args);
+    const std::vector<std::string> &args, alkaidsd::Node num_neighbors, bool filter_route_pairs,
+    bool prune_route_pairs);
+void ParseScanPolicies(
+    const std::vector<std::string> &args, const std::vector<std::string> &inter_operator_names,
+    std::vector<std::unique_ptr<alkaidsd::inter_operator::InterOperator>> &inter_operators);
 std::vector<std::unique_ptr<alkaidsd::intra_operator::IntraOperator>> ParseIntraOperators(
-    const std::vector<std::string> &args);
+    const std::vector<std::string> &args, double two_opt_sparsification,
+    alkaidsd::Node held_karp_size);
 std::function<std::unique_ptr<alkaidsd::acceptance_rule::AcceptanceRule>()> ParseAcceptanceRule(
     const std::string &type, const std::vector<std::string> &args);
 std::unique_ptr<alkaidsd::ruin_method::RuinMethod> ParseRuinMethod(
@@ -21,6 +26,10 @@ std::map<std::string, double> ParseFromArgs(const std::vector<std::string> &args
 
 class SimpleListener : public alkaidsd::Listener {
 public:
+  SimpleListener(std::vector<std::string> inter_operators,
+                 std::vector<std::string> intra_operators)
+      : inter_operators_(std::move(inter_operators)),
+        intra_operators_(std::move(intra_operators)) {}
   void OnStart() override { start_time_ = std::chrono::system_clock::now(); }
   void OnUpdated([[maybe_unused]] const alkaidsd::AlkaidSolution &solution, int objective) override {
     auto elapsed_time = std::chrono::duration_cast<std::chrono::duration<double>>(
@@ -32,9 +41,31 @@ public:
         std::chrono::system_clock::now() - start_time_);
     std::cout << "End at " << elapsed_time.count() << "s: " << objective << std::endl;
   }
+  void OnStatistics(const alkaidsd::Statistics &statistics) override {
+    for (size_t i = 0; i < statistics.inter_operators.size(); ++i) {
+      auto &&operator_statistics = statistics.inter_operators[i];
+      std::cout << inter_operators_[i] << ": calls=" << operator_statistics.num_calls
+                << " improvements=" << operator_statistics.num_improvements
+                << " hits=" << operator_statistics.num_cache_hits
+                << " misses=" << operator_statistics.num_cache_misses
+                << " invalidations=" << operator_statistics.num_cache_invalidations
+                << " preprocesses=" << operator_statistics.num_preprocesses
+                << " evaluations=" << operator_statistics.num_evaluations
+                << " filtered=" << operator_statistics.num_filtered_pairs
+                << " weight=" << operator_statistics.weight << std::endl;
+    }
+    for (size_t i = 0; i < statistics.intra_operators.size(); ++i) {
+      auto &&operator_statistics = statistics.intra_operators[i];
+      std::cout << intra_operators_[i] << ": calls=" << operator_statistics.num_calls
+                << " improvements=" << operator_statistics.num_improvements
+                << " weight=" << operator_statistics.weight << std::endl;
+    }
+  }
 
 private:
   std::chrono::system_clock::time_point start_time_;
+  std::vector<std::string> inter_operators_;
+  std::vector<std::string> intra_operators_;
 };
 
 int main(int argc, char **argv) {
@@ -54,11 +85,48 @@ int main(int argc, char **argv) {
   app.add_option("--random-seed", config.random_seed, "Random seed")
       ->default_val(std::random_device{}());
   app.add_option("--time-limit", config.time_limit, "Time limit")->required();
+  app.add_option("--num-threads", config.num_threads, "Number of threads")->default_val(1);
+  app.add_flag("--multi-start", config.multi_start,
+               "Run one independent restart loop per thread, sharing only the best solution");
   app.add_option("--blink-rate", config.blink_rate, "Blink rate")->required();
+  std::map<std::string, alkaidsd::ConstructionMethod> construction_methods{
+      {"insertion", alkaidsd::kCheapestInsertion},
+      {"savings", alkaidsd::kSavings},
+      {"sweep", alkaidsd::kSweep}};
+  app.add_option("--construction-methods", config.construction_methods,
+                 "Methods building the initial solution of each restart, one picked at random")
+      ->transform(CLI::CheckedTransformer(construction_methods));
+  app.add_option("--num-restart-candidates", config.num_restart_candidates,
+                 "Initial solutions built concurrently at each restart, of which the best after "
+                 "one descent is kept")
+      ->default_val(1);
+  app.add_option("--reinsertion-neighbors", config.reinsertion_neighbors,
+                 "Nearest neighbors whose routes are evaluated when reinserting a customer (0 "
+                 "evaluates all routes)")
+      ->default_val(0);
   std::vector<std::string> inter_operators;
   app.add_option("--inter-operators", inter_operators, "Inter operators")->required();
+  int granular_neighbors;
+  app.add_option("--granular-neighbors", granular_neighbors,
+                 "Nearest neighbors per customer for granular inter operators (0 disables)")
+      ->default_val(0);
+  bool filter_route_pairs = false;
+  app.add_flag("--filter-route-pairs", filter_route_pairs,
+               "Skip route pairs with disjoint bounding circles in SwapStar, SdSwapStar and Cross");
+  bool prune_route_pairs = false;
+  app.add_flag("--prune-route-pairs", prune_route_pairs,
+               "Skip route pairs that cannot improve by a lower bound in SwapStar and SdSwapStar");
+  std::vector<std::string> scan_policies;
+  app.add_option("--scan-policies", scan_policies, "Scan policies of inter operators");
   std::vector<std::string> intra_operators;
   app.add_option("--intra-operators", intra_operators, "Intra operators")->required();
+  double two_opt_sparsification;
+  app.add_option("--two-opt-sparsification", two_opt_sparsification,
+                 "Longest new edge evaluated by TwoOpt relative to the average route edge")
+      ->default_val(0);
+  alkaidsd::Node held_karp_size;
+  app.add_option("--held-karp-size", held_karp_size, "Largest route solved exactly by HeldKarp")
+      ->default_val(10);
   std::string acceptance_rule_type;
   app.add_option("--acceptance-rule-type", acceptance_rule_type, "Acceptance rule type")
       ->required();
@@ -70,16 +138,44 @@ int main(int argc, char **argv) {
   app.add_option("--ruin-method-args", ruin_method_args, "Ruin method args");
   std::vector<std::string> sorters;
   app.add_option("--sorters", sorters, "Sorters")->required();
+  app.add_flag("--collect-statistics", config.collect_statistics, "Report operator statistics");
+  app.add_flag("--adaptive-selection", config.adaptive_selection,
+               "Select operators by their recent improvement per microsecond");
+  app.add_option("--selection-decay", config.selection_decay, "Decay of the selection weights")
+      ->default_val(0.99);
+  std::map<std::string, alkaidsd::DescentMode> descent_modes{
+      {"sequential", alkaidsd::kSequentialDescent},
+      {"speculative-best", alkaidsd::kSpeculativeBest},
+      {"speculative-first", alkaidsd::kSpeculativeFirst}};
+  app.add_option("--descent-mode", config.descent_mode,
+                 "Search the inter operators one by one or concurrently on the thread pool")
+      ->transform(CLI::CheckedTransformer(descent_modes));
+  std::string solver_type;
+  app.add_option("--solver", solver_type,
+                 "Call the operators through virtual dispatch (dynamic) or use the prebuilt static "
+                 "solver of example-config.ini (example-config)")
+      ->check(CLI::IsMember({"dynamic", "example-config"}))
+      ->default_val("dynamic");
   CLI11_PARSE(app, argc, argv);
-  config.inter_operators = ParseInterOperators(inter_operators);
-  config.intra_operators = ParseIntraOperators(intra_operators);
+  config.inter_operators
+      = ParseInterOperators(inter_operators, granular_neighbors, filter_route_pairs,
+                            prune_route_pairs);
+  ParseScanPolicies(scan_policies, inter_operators, config.inter_operators);
+  config.intra_operators = ParseIntraOperators(intra_operators, two_opt_sparsification,
+                                                held_karp_size);
   config.acceptance_rule = ParseAcceptanceRule(acceptance_rule_type, acceptance_rule_args);
   config.ruin_method = ParseRuinMethod(ruin_method_type, ruin_method_args);
   config.sorter = ParseSorter(sorters);
-  config.listener = std::make_unique<SimpleListener>();
+  config.listener = std::make_unique<SimpleListener>(inter_operators, intra_operators);
   auto instance = ReadInstanceFromFile(instance_path, input_format);
   auto distance_matrix_optimizer = alkaidsd::DistanceMatrixOptimizer(instance.distance_matrix);
-  alkaidsd::AlkaidSolver solver;
+  alkaidsd::AlkaidSolver dynamic_solver;
+  alkaidsd::ExampleConfigSolver example_config_solver;
+  alkaidsd::Solver<alkaidsd::AlkaidSolution, alkaidsd::AlkaidConfig, alkaidsd::Instance> &solver
+      = solver_type == "example-config"
+            ? static_cast<alkaidsd::Solver<alkaidsd::AlkaidSolution, alkaidsd::AlkaidConfig,
+                                           alkaidsd::Instance> &>(example_config_solver)
+            : dynamic_solver;
   auto solution = solver.Solve(config, instance);
   distance_matrix_optimizer.Restore(solution);
   std::ofstream ofs(output);
@@ -93,25 +189,34 @@ int main(int argc, char **argv) {
 }
 
 std::vector<std::unique_ptr<alkaidsd::inter_operator::InterOperator>> ParseInterOperators(
-    const std::vector<std::string> &args) {
+    const std::vector<std::string> &args, alkaidsd::Node num_neighbors, bool filter_route_pairs,
+    bool prune_route_pairs) {
   std::vector<std::unique_ptr<alkaidsd::inter_operator::InterOperator>> inter_operators;
   for (const auto &arg : args) {
     if (arg == "Swap<2, 0>") {
-      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::Swap<2, 0>>());
+      inter_operators.push_back(
+          std::make_unique<alkaidsd::inter_operator::Swap<2, 0>>(num_neighbors));
     } else if (arg == "Swap<2, 1>") {
-      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::Swap<2, 1>>());
+      inter_operators.push_back(
+          std::make_unique<alkaidsd::inter_operator::Swap<2, 1>>(num_neighbors));
     } else if (arg == "Swap<2, 2>") {
-      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::Swap<2, 2>>());
+      inter_operators.push_back(
+          std::make_unique<alkaidsd::inter_operator::Swap<2, 2>>(num_neighbors));
     } else if (arg == "Relocate") {
-      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::Relocate>());
+      inter_operators.push_back(
+          std::make_unique<alkaidsd::inter_operator::Relocate>(num_neighbors));
     } else if (arg == "SwapStar") {
-      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::SwapStar>());
+      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::SwapStar>(
+          filter_route_pairs, prune_route_pairs));
     } else if (arg == "Cross") {
-      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::Cross>());
+      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::Cross>(
+          num_neighbors, filter_route_pairs));
     } else if (arg == "SdSwapStar") {
-      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::SdSwapStar>());
+      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::SdSwapStar>(
+          filter_route_pairs, prune_route_pairs));
     } else if (arg == "SdSwapOneOne") {
-      inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::SdSwapOneOne>());
+      inter_operators.push_back(
+          std::make_unique<alkaidsd::inter_operator::SdSwapOneOne>(num_neighbors));
     } else if (arg == "SdSwapTwoOne") {
       inter_operators.push_back(std::make_unique<alkaidsd::inter_operator::SdSwapTwoOne>());
     } else {
@@ -121,8 +226,41 @@ std::vector<std::unique_ptr<alkaidsd::inter_operator::InterOperator>> ParseInter
   return inter_operators;
 }
 
+void ParseScanPolicies(
+    const std::vector<std::string> &args, const std::vector<std::string> &inter_operator_names,
+    std::vector<std::unique_ptr<alkaidsd::inter_operator::InterOperator>> &inter_operators) {
+  for (const auto &arg : args) {
+    auto pos = arg.rfind('=');
+    if (pos == std::string::npos) {
+      throw std::invalid_argument("Invalid scan policy.");
+    }
+    auto name = arg.substr(0, pos);
+    auto value = arg.substr(pos + 1);
+    alkaidsd::inter_operator::ScanPolicy scan_policy;
+    if (value == "best") {
+      scan_policy.strategy = alkaidsd::inter_operator::kBestImprovement;
+    } else if (value == "first") {
+      scan_policy.strategy = alkaidsd::inter_operator::kFirstImprovement;
+    } else {
+      scan_policy.strategy = alkaidsd::inter_operator::kSampledImprovement;
+      scan_policy.sample_rate = std::stod(value);
+    }
+    bool found = false;
+    for (size_t i = 0; i < inter_operator_names.size(); ++i) {
+      if (inter_operator_names[i] == name) {
+        inter_operators[i]->SetScanPolicy(scan_policy);
+        found = true;
+      }
+    }
+    if (!found) {
+      throw std::invalid_argument("Invalid scan policy.");
+    }
+  }
+}
+
 std::vector<std::unique_ptr<alkaidsd::intra_operator::IntraOperator>> ParseIntraOperators(
-    const std::vector<std::string> &args) {
+    const std::vector<std::string> &args, double two_opt_sparsification,
+    alkaidsd::Node held_karp_size) {
   std::vector<std::unique_ptr<alkaidsd::intra_operator::IntraOperator>> intra_operators;
   for (const auto &arg : args) {
     if (arg == "Exchange") {
@@ -133,6 +271,12 @@ std::vector<std::unique_ptr<alkaidsd::intra_operator::IntraOperator>> ParseIntra
       intra_operators.push_back(std::make_unique<alkaidsd::intra_operator::OrOpt<2>>());
     } else if (arg == "OrOpt<3>") {
       intra_operators.push_back(std::make_unique<alkaidsd::intra_operator::OrOpt<3>>());
+    } else if (arg == "TwoOpt") {
+      intra_operators.push_back(
+          std::make_unique<alkaidsd::intra_operator::TwoOpt>(two_opt_sparsification));
+    } else if (arg == "HeldKarp") {
+      intra_operators.push_back(
+          std::make_unique<alkaidsd::intra_operator::HeldKarp>(held_karp_size));
     } else {
       throw std::invalid_argument("Invalid intra operator.");
     }
@@ -0,0 +1,80 @@
+#include <doctest/doctest.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include "construction.h"
+#include "random.h"
+
+namespace {
+  using namespace alkaidsd;
+
+  // Random points on a grid with Manhattan distances. Some demands exceed the capacity, so that
+  // they must be split.
+  Instance MakeRandomInstance(Node num_customers, Random &random) {
+    std::vector<int> xs(num_customers), ys(num_customers);
+    Instance instance;
+    instance.num_customers = num_customers;
+    instance.capacity = 50;
+    instance.demands.resize(num_customers);
+    for (Node i = 0; i < num_customers; ++i) {
+      xs[i] = random.NextInt(-50, 50);
+      ys[i] = random.NextInt(-50, 50);
+      instance.demands[i] = i ? random.NextInt(1, 80) : 0;
+    }
+    instance.distance_matrix.assign(num_customers, std::vector<int>(num_customers));
+    for (Node i = 0; i < num_customers; ++i) {
+      for (Node j = 0; j < num_customers; ++j) {
+        instance.distance_matrix[i][j] = std::abs(xs[i] - xs[j]) + std::abs(ys[i] - ys[j]);
+      }
+    }
+    return instance;
+  }
+
+  // Every demand is served exactly and no route exceeds the capacity.
+  bool IsFeasible(const Instance &instance, const AlkaidSolution &solution) {
+    std::vector<int> loads(instance.num_customers);
+    for (Node node_index : solution.NodeIndices()) {
+      if (solution.Load(node_index) <= 0) {
+        return false;
+      }
+      loads[solution.Customer(node_index)] += solution.Load(node_index);
+      if (!solution.Predecessor(node_index)) {
+        int load = 0;
+        for (Node route_node = node_index; route_node; route_node = solution.Successor(route_node)) {
+          load += solution.Load(route_node);
+        }
+        if (load > instance.capacity) {
+          return false;
+        }
+      }
+    }
+    return loads == instance.demands;
+  }
+}  // namespace
+
+TEST_CASE("Cheapest insertion builds feasible solutions") {
+  using namespace alkaidsd;
+
+  // Each seed draws the sequential or the parallel insertion and one of the two criteria.
+  Random random(11);
+  for (int i = 0; i < 20; ++i) {
+    auto instance = MakeRandomInstance(i % 2 ? 60 : 8, random);
+    CHECK(IsFeasible(instance, Construct(instance, random)));
+  }
+}
+
+TEST_CASE("Savings and sweep serve every demand within the capacity") {
+  using namespace alkaidsd;
+
+  Random random(13);
+  for (auto method : {kSavings, kSweep}) {
+    for (Node num_customers : {2, 3, 8, 60}) {
+      auto instance = MakeRandomInstance(num_customers, random);
+      Constructor constructor(instance, {method});
+      for (int i = 0; i < 5; ++i) {
+        CHECK(IsFeasible(instance, constructor.Construct(instance, random)));
+      }
+    }
+  }
+}
@@ -0,0 +1,336 @@
+#include <alkaidsd/inter_operator.h>
+#include <doctest/doctest.h>
+
+#include <cstdlib>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "cache.h"
+#include "construction.h"
+#include "inter_operator/base_star.h"
+#include "inter_operator/bounding_circle.h"
+#include "random.h"
+#include "route_context.h"
+#include "thread_pool.h"
+
+namespace {
+  using namespace alkaidsd;
+
+  // Random points on a grid with Manhattan distances, so that the triangle inequality holds.
+  Instance MakeRandomInstance(Node num_customers, Random &random, int spread = 50) {
+    std::vector<int> xs(num_customers), ys(num_customers);
+    Instance instance;
+    instance.num_customers = num_customers;
+    instance.capacity = 50;
+    instance.demands.resize(num_customers);
+    for (Node i = 0; i < num_customers; ++i) {
+      xs[i] = random.NextInt(-spread, spread);
+      ys[i] = random.NextInt(-spread, spread);
+      instance.demands[i] = i ? random.NextInt(1, 40) : 0;
+    }
+    instance.distance_matrix.assign(num_customers, std::vector<int>(num_customers));
+    for (Node i = 0; i < num_customers; ++i) {
+      for (Node j = 0; j < num_customers; ++j) {
+        instance.distance_matrix[i][j] = std::abs(xs[i] - xs[j]) + std::abs(ys[i] - ys[j]);
+      }
+    }
+    return instance;
+  }
+
+  // Applies the operators in turn until none improves, as the sequential descent does, and
+  // returns the customers of the routes in order.
+  std::vector<Node> Descend(const Instance &instance, int num_threads) {
+    std::vector<std::unique_ptr<inter_operator::InterOperator>> inter_operators;
+    inter_operators.push_back(std::make_unique<inter_operator::Relocate>());
+    inter_operators.push_back(std::make_unique<inter_operator::Swap<2, 1>>());
+    inter_operators.push_back(std::make_unique<inter_operator::Cross>());
+    inter_operators.push_back(std::make_unique<inter_operator::SwapStar>());
+    inter_operators.push_back(std::make_unique<inter_operator::SdSwapStar>());
+    Random random(42);
+    auto solution = Construct(instance, random);
+    RouteContext context;
+    context.CalcRouteContext(solution);
+    ThreadPool thread_pool(num_threads);
+    CacheMap cache_map;
+    cache_map.SetThreadPool(thread_pool);
+    cache_map.Reset(solution, context);
+    bool improved = true;
+    while (improved) {
+      improved = false;
+      for (auto &&inter_operator : inter_operators) {
+        auto routes = (*inter_operator)(instance, solution, context, random, cache_map);
+        for (Node route_index : routes) {
+          cache_map.RemoveRoute(route_index);
+          if (context.Head(route_index)) {
+            context.UpdateRouteContext(solution, route_index, 0);
+            cache_map.AddRoute(route_index);
+          } else {
+            context.RemoveRoute(route_index);
+          }
+        }
+        improved = improved || !routes.empty();
+      }
+    }
+    std::vector<Node> customers;
+    for (Node route_index : context.ActiveRoutes()) {
+      for (Node node_index = context.Head(route_index); node_index;
+           node_index = solution.Successor(node_index)) {
+        customers.push_back(solution.Customer(node_index));
+      }
+      customers.push_back(0);
+    }
+    return customers;
+  }
+
+  // Calls the operator once on a copy of the solution and returns the objective it reaches.
+  int ApplyOnce(const Instance &instance, const AlkaidSolution &solution,
+                const inter_operator::InterOperator &inter_operator) {
+    auto copy = solution;
+    RouteContext context;
+    context.CalcRouteContext(copy);
+    CacheMap cache_map;
+    cache_map.Reset(copy, context);
+    Random random(1);
+    inter_operator(instance, copy, context, random, cache_map);
+    return copy.CalcObjective(instance);
+  }
+
+  // Whether the bounding circles of every pair of routes overlap.
+  bool AllCirclesOverlap(const Instance &instance, const AlkaidSolution &solution,
+                         const RouteContext &context) {
+    inter_operator::BoundingCircles circles;
+    circles.Reset(solution, context);
+    for (Node route_a : context.ActiveRoutes()) {
+      for (Node route_b : context.ActiveRoutes()) {
+        if (route_a < route_b && !circles.Overlap(instance, solution, context, route_a, route_b)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Checks on constructed solutions, and on the solutions along a descent, that the filtered
+  // operator never worsens the solution nor beats the best move of the full operator. With
+  // `exact` set, it must find a move as good as that best move. Otherwise the filter may skip the
+  // route pairs whose circles are disjoint, so the moves only have to match when every pair of
+  // circles overlaps, which the dense instances with long routes provide. Returns the number of
+  // solutions on which the moves were compared.
+  int CheckFilter(const inter_operator::InterOperator &inter_operator,
+                  const inter_operator::InterOperator &filtered_operator, bool exact) {
+    Random random(5);
+    int num_checks = 0;
+    for (auto [spread, capacity] : {std::pair{50, 50}, {50, 50}, {5, 300}, {5, 300}}) {
+      auto instance = MakeRandomInstance(50, random, spread);
+      instance.capacity = capacity;
+      auto solution = Construct(instance, random);
+      RouteContext context;
+      context.CalcRouteContext(solution);
+      CacheMap cache_map;
+      cache_map.Reset(solution, context);
+      while (true) {
+        int current = solution.CalcObjective(instance);
+        int objective = ApplyOnce(instance, solution, inter_operator);
+        int filtered_objective = ApplyOnce(instance, solution, filtered_operator);
+        CHECK(filtered_objective >= objective);
+        CHECK(filtered_objective <= current);
+        if (exact || AllCirclesOverlap(instance, solution, context)) {
+          CHECK(filtered_objective == objective);
+          ++num_checks;
+        }
+        auto routes = inter_operator(instance, solution, context, random, cache_map);
+        if (routes.empty()) {
+          break;
+        }
+        for (Node route_index : routes) {
+          cache_map.RemoveRoute(route_index);
+          if (context.Head(route_index)) {
+            context.UpdateRouteContext(solution, route_index, 0);
+            cache_map.AddRoute(route_index);
+          } else {
+            context.RemoveRoute(route_index);
+          }
+        }
+      }
+    }
+    return num_checks;
+  }
+}  // namespace
+
+TEST_CASE("Inter operators do not depend on the number of threads") {
+  using namespace alkaidsd;
+
+  Random random(7);
+  auto instance = MakeRandomInstance(60, random);
+  auto customers = Descend(instance, 1);
+  CHECK(Descend(instance, 4) == customers);
+}
+
+TEST_CASE("Operator statistics are bound per cache map and scope") {
+  using namespace alkaidsd;
+
+  CacheMap cache_map;
+  OperatorStatistics statistics;
+  {
+    CacheMap::StatisticsScope statistics_scope(cache_map, &statistics);
+    CHECK(cache_map.Statistics() == &statistics);
+    CacheMap other_cache_map;
+    CHECK(other_cache_map.Statistics() == nullptr);
+  }
+  CHECK(cache_map.Statistics() == nullptr);
+}
+
+TEST_CASE("Incremental star caches match a full preprocess") {
+  using namespace alkaidsd;
+
+  Random random(11);
+  auto instance = MakeRandomInstance(40, random);
+  auto solution = Construct(instance, random);
+  RouteContext context;
+  context.CalcRouteContext(solution);
+  inter_operator::StarCaches caches;
+  caches.Reset(solution, context);
+  for (Node route_index : context.ActiveRoutes()) {
+    caches.Preprocess(instance, solution, context, route_index, random, nullptr);
+  }
+  for (int i = 0; i < 20; ++i) {
+    // Moves the second node of a route after the head of another one, so that most edges of
+    // both routes are kept.
+    auto &&routes = context.ActiveRoutes();
+    Node from = routes[random.NextInt(0, static_cast<int>(routes.size()) - 1)];
+    Node to = routes[random.NextInt(0, static_cast<int>(routes.size()) - 1)];
+    Node node_index = solution.Successor(context.Head(from));
+    if (from == to || !node_index) {
+      continue;
+    }
+    solution.Link(context.Head(from), solution.Successor(node_index));
+    solution.Link(node_index, solution.Successor(context.Head(to)));
+    solution.Link(context.Head(to), node_index);
+    inter_operator::StarCaches full_caches;
+    full_caches.Reset(solution, context);
+    for (Node route_index : {from, to}) {
+      context.UpdateRouteContext(solution, route_index, 0);
+      caches.RemoveRoute(route_index);
+      caches.AddRoute(route_index);
+      caches.Preprocess(instance, solution, context, route_index, random, nullptr);
+      full_caches.Preprocess(instance, solution, context, route_index, random, nullptr);
+      for (Node customer = 1; customer < instance.num_customers; ++customer) {
+        auto &&insertions = caches.Get(route_index, customer).insertions;
+        auto &&full_insertions = full_caches.Get(route_index, customer).insertions;
+        for (int k = 0; k < 3; ++k) {
+          CHECK(insertions[k].delta.value == full_insertions[k].delta.value);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Bounding circles only skip disjoint route pairs") {
+  using namespace alkaidsd;
+
+  CHECK(CheckFilter(inter_operator::SwapStar(), inter_operator::SwapStar(true), false) > 0);
+  CHECK(CheckFilter(inter_operator::SdSwapStar(), inter_operator::SdSwapStar(true), false) > 0);
+  CHECK(CheckFilter(inter_operator::Cross(), inter_operator::Cross(0, true), false) > 0);
+}
+
+TEST_CASE("Route bounds never prune an improving route pair") {
+  using namespace alkaidsd;
+
+  CHECK(CheckFilter(inter_operator::SwapStar(), inter_operator::SwapStar(false, true), true) > 0);
+  CHECK(CheckFilter(inter_operator::SdSwapStar(), inter_operator::SdSwapStar(false, true), true)
+        > 0);
+}
+
+TEST_CASE("Granular operators with every neighbor match the full operators") {
+  using namespace alkaidsd;
+
+  CHECK(CheckFilter(inter_operator::Relocate(), inter_operator::Relocate(49), true) > 0);
+  CHECK(CheckFilter(inter_operator::Swap<1, 1>(), inter_operator::Swap<1, 1>(49), true) > 0);
+  CHECK(CheckFilter(inter_operator::Swap<2, 1>(), inter_operator::Swap<2, 1>(49), true) > 0);
+  CHECK(CheckFilter(inter_operator::Swap<1, 0>(), inter_operator::Swap<1, 0>(49), true) > 0);
+  CHECK(CheckFilter(inter_operator::Swap<2, 2>(), inter_operator::Swap<2, 2>(49), true) > 0);
+  CHECK(CheckFilter(inter_operator::Cross(), inter_operator::Cross(49), true) > 0);
+  CHECK(CheckFilter(inter_operator::SdSwapOneOne(), inter_operator::SdSwapOneOne(49), true) > 0);
+}
+
+TEST_CASE("Granular and full operators keep separate pair caches") {
+  using namespace alkaidsd;
+
+  Random random(9);
+  auto instance = MakeRandomInstance(50, random);
+  auto solution = Construct(instance, random);
+  RouteContext context;
+  context.CalcRouteContext(solution);
+  inter_operator::Relocate relocate;
+  int objective = ApplyOnce(instance, solution, relocate);
+  // The granular operator leaves its pair caches up to date, and the full one must not take
+  // them for its own.
+  CacheMap cache_map;
+  cache_map.Reset(solution, context);
+  for (Node num_neighbors : {1, 3}) {
+    auto copy = solution;
+    auto copy_context = context;
+    inter_operator::Relocate granular(num_neighbors);
+    granular(instance, copy, copy_context, random, cache_map);
+  }
+  relocate(instance, solution, context, random, cache_map);
+  CHECK(solution.CalcObjective(instance) == objective);
+}
+
+TEST_CASE("Every scan policy only applies improving moves") {
+  using namespace alkaidsd;
+
+  std::vector<std::unique_ptr<inter_operator::InterOperator>> inter_operators;
+  inter_operators.push_back(std::make_unique<inter_operator::Relocate>());
+  inter_operators.push_back(std::make_unique<inter_operator::Swap<2, 1>>());
+  inter_operators.push_back(std::make_unique<inter_operator::Cross>());
+  inter_operators.push_back(std::make_unique<inter_operator::SwapStar>());
+  inter_operators.push_back(std::make_unique<inter_operator::SdSwapStar>());
+  inter_operators.push_back(std::make_unique<inter_operator::SdSwapOneOne>());
+  inter_operators.push_back(std::make_unique<inter_operator::SdSwapTwoOne>());
+  for (auto scan_policy : {inter_operator::ScanPolicy{inter_operator::kBestImprovement},
+                           inter_operator::ScanPolicy{inter_operator::kFirstImprovement},
+                           inter_operator::ScanPolicy{inter_operator::kSampledImprovement, 0.5}}) {
+    for (auto &&inter_operator : inter_operators) {
+      inter_operator->SetScanPolicy(scan_policy);
+    }
+    Random random(3);
+    auto instance = MakeRandomInstance(50, random);
+    auto solution = Construct(instance, random);
+    RouteContext context;
+    context.CalcRouteContext(solution);
+    ThreadPool thread_pool(2);
+    CacheMap cache_map;
+    cache_map.SetThreadPool(thread_pool);
+    cache_map.Reset(solution, context);
+    int objective = solution.CalcObjective(instance);
+    int num_moves = 0;
+    bool improved = true;
+    while (improved) {
+      improved = false;
+      for (auto &&inter_operator : inter_operators) {
+        auto routes = (*inter_operator)(instance, solution, context, random, cache_map);
+        int new_objective = solution.CalcObjective(instance);
+        if (routes.empty()) {
+          CHECK(new_objective == objective);
+          continue;
+        }
+        CHECK(new_objective < objective);
+        objective = new_objective;
+        ++num_moves;
+        improved = true;
+        for (Node route_index : routes) {
+          cache_map.RemoveRoute(route_index);
+          if (context.Head(route_index)) {
+            context.UpdateRouteContext(solution, route_index, 0);
+            cache_map.AddRoute(route_index);
+          } else {
+            context.RemoveRoute(route_index);
+          }
+        }
+      }
+    }
+    CHECK(num_moves > 0);
+  }
+}
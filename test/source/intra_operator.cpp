@@ -0,0 +1,91 @@
+#include <alkaidsd/intra_operator.h>
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "random.h"
+#include "route_context.h"
+
+namespace {
+  using namespace alkaidsd;
+
+  // Random symmetric distances, which do not need to satisfy the triangle inequality.
+  Instance MakeRandomInstance(Node num_customers, Random &random) {
+    Instance instance;
+    instance.num_customers = num_customers;
+    instance.capacity = num_customers;
+    instance.demands.assign(num_customers, 1);
+    instance.demands[0] = 0;
+    instance.distance_matrix.assign(num_customers, std::vector<int>(num_customers));
+    for (Node i = 0; i < num_customers; ++i) {
+      for (Node j = 0; j < i; ++j) {
+        instance.distance_matrix[i][j] = instance.distance_matrix[j][i] = random.NextInt(1, 100);
+      }
+    }
+    return instance;
+  }
+
+  // A single route visiting the customers in the given order.
+  AlkaidSolution MakeRoute(const std::vector<Node> &customers) {
+    AlkaidSolution solution;
+    Node predecessor = 0;
+    for (Node customer : customers) {
+      predecessor = solution.Insert(customer, 1, predecessor, 0);
+    }
+    return solution;
+  }
+
+  int CalcOptimalCost(const Instance &instance) {
+    std::vector<Node> customers(instance.num_customers - 1);
+    std::iota(customers.begin(), customers.end(), 1);
+    int optimal_cost = std::numeric_limits<int>::max();
+    do {
+      optimal_cost = std::min(optimal_cost, MakeRoute(customers).CalcObjective(instance));
+    } while (std::next_permutation(customers.begin(), customers.end()));
+    return optimal_cost;
+  }
+
+  // Applies the operator to a shuffled route until it makes no more moves, checks that no call
+  // makes the route longer, and returns the final cost.
+  int ImproveShuffledRoute(const intra_operator::IntraOperator &intra_operator,
+                           const Instance &instance, Random &random) {
+    std::vector<Node> customers(instance.num_customers - 1);
+    std::iota(customers.begin(), customers.end(), 1);
+    random.Shuffle(customers.begin(), customers.end());
+    auto solution = MakeRoute(customers);
+    RouteContext context;
+    context.CalcRouteContext(solution);
+    int cost = solution.CalcObjective(instance);
+    while (intra_operator(instance, 0, solution, context, random)) {
+      int new_cost = solution.CalcObjective(instance);
+      CHECK(new_cost <= cost);
+      cost = new_cost;
+    }
+    CHECK(solution.NodeIndices().size() == customers.size());
+    return cost;
+  }
+}  // namespace
+
+TEST_CASE("TwoOpt never worsens a route") {
+  using namespace alkaidsd;
+
+  Random random(42);
+  for (int i = 0; i < 20; ++i) {
+    auto instance = MakeRandomInstance(8, random);
+    ImproveShuffledRoute(intra_operator::TwoOpt(), instance, random);
+  }
+}
+
+TEST_CASE("HeldKarp solves a small route exactly") {
+  using namespace alkaidsd;
+
+  Random random(42);
+  for (int i = 0; i < 20; ++i) {
+    auto instance = MakeRandomInstance(8, random);
+    CHECK(ImproveShuffledRoute(intra_operator::HeldKarp(), instance, random)
+          == CalcOptimalCost(instance));
+  }
+}
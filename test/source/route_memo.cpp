@@ -0,0 +1,34 @@
+#include <doctest/doctest.h>
+
+#include "route_memo.h"
+
+TEST_CASE("RouteMemo remembers routes until they change") {
+  using namespace alkaidsd;
+
+  AlkaidSolution solution;
+  Node head = solution.Insert(1, 5, 0, 0);
+  Node tail = solution.Insert(2, 3, head, 0);
+  RouteMemo route_memo;
+  CHECK(!route_memo.Contains(RouteMemo::Sign(solution, head)));
+  route_memo.Insert(RouteMemo::Sign(solution, head));
+  CHECK(route_memo.Contains(RouteMemo::Sign(solution, head)));
+
+  solution.SetLoad(tail, 4);
+  CHECK(!route_memo.Contains(RouteMemo::Sign(solution, head)));
+  solution.SetLoad(tail, 3);
+  CHECK(route_memo.Contains(RouteMemo::Sign(solution, head)));
+
+  // The same customers in another order, and a customer only differing in the high bits.
+  solution.Link(0, tail);
+  solution.Link(tail, head);
+  solution.Link(head, 0);
+  CHECK(!route_memo.Contains(RouteMemo::Sign(solution, tail)));
+  solution.SetCustomer(head, static_cast<Node>(1 | 1 << 14));
+  route_memo.Insert(RouteMemo::Sign(solution, tail));
+  solution.SetCustomer(head, 1);
+  CHECK(!route_memo.Contains(RouteMemo::Sign(solution, tail)));
+
+  solution.Insert(3, 1, head, 0);
+  CHECK(RouteMemo::Sign(solution, tail).num_nodes == 3);
+  CHECK(!route_memo.Contains(RouteMemo::Sign(solution, tail)));
+}
@@ -0,0 +1,55 @@
+#include <alkaidsd/ruin_method.h>
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "construction.h"
+#include "random.h"
+#include "route_context.h"
+
+namespace {
+  using namespace alkaidsd;
+
+  // Random points on a grid with Manhattan distances, so that the triangle inequality holds.
+  Instance MakeRandomInstance(Node num_customers, Random &random) {
+    std::vector<int> xs(num_customers), ys(num_customers);
+    Instance instance;
+    instance.num_customers = num_customers;
+    instance.capacity = 50;
+    instance.demands.resize(num_customers);
+    for (Node i = 0; i < num_customers; ++i) {
+      xs[i] = random.NextInt(-50, 50);
+      ys[i] = random.NextInt(-50, 50);
+      instance.demands[i] = i ? random.NextInt(1, 40) : 0;
+    }
+    instance.distance_matrix.assign(num_customers, std::vector<int>(num_customers));
+    for (Node i = 0; i < num_customers; ++i) {
+      for (Node j = 0; j < num_customers; ++j) {
+        instance.distance_matrix[i][j] = std::abs(xs[i] - xs[j]) + std::abs(ys[i] - ys[j]);
+      }
+    }
+    return instance;
+  }
+}  // namespace
+
+TEST_CASE("SisrsRuin walks past its nearest neighbors without Reset") {
+  using namespace alkaidsd;
+
+  Random random(3);
+  auto instance = MakeRandomInstance(60, random);
+  // Few neighbors per customer and short strings, so that walks often run past the lists.
+  ruin_method::SisrsRuin ruin_method(2, 1, 0.740, 0.096);
+  for (int i = 0; i < 50; ++i) {
+    auto solution = Construct(instance, random);
+    RouteContext context;
+    context.CalcRouteContext(solution);
+    auto customers = ruin_method.Ruin(instance, solution, context, random);
+    CHECK(!customers.empty());
+    std::sort(customers.begin(), customers.end());
+    CHECK(std::adjacent_find(customers.begin(), customers.end()) == customers.end());
+    CHECK(customers.front() >= 1);
+    CHECK(customers.back() < instance.num_customers);
+  }
+}
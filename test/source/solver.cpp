@@ -2,12 +2,111 @@
 #include <alkaidsd/version.h>
 #include <doctest/doctest.h>
 
+#include <cstdlib>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+  using namespace alkaidsd;
+
+  // Records the objective reported at the end of a solve.
+  class EndListener : public Listener {
+  public:
+    explicit EndListener(int &objective) : objective_(objective) {}
+    void OnStart() override {}
+    void OnUpdated([[maybe_unused]] const AlkaidSolution &solution,
+                   [[maybe_unused]] int objective) override {}
+    void OnEnd([[maybe_unused]] const AlkaidSolution &solution, int objective) override {
+      objective_ = objective;
+    }
+
+  private:
+    int &objective_;
+  };
+
+  // The operators, acceptance rule and ruin method of example-config.ini.
+  AlkaidConfig MakeExampleConfig(uint32_t random_seed, double time_limit) {
+    AlkaidConfig config;
+    config.random_seed = random_seed;
+    config.time_limit = time_limit;
+    config.blink_rate = 0.021;
+    config.inter_operators.push_back(std::make_unique<inter_operator::Relocate>());
+    config.inter_operators.push_back(std::make_unique<inter_operator::Swap<2, 0>>());
+    config.inter_operators.push_back(std::make_unique<inter_operator::Swap<2, 1>>());
+    config.inter_operators.push_back(std::make_unique<inter_operator::Swap<2, 2>>());
+    config.inter_operators.push_back(std::make_unique<inter_operator::Cross>());
+    config.inter_operators.push_back(std::make_unique<inter_operator::SwapStar>());
+    config.inter_operators.push_back(std::make_unique<inter_operator::SdSwapStar>());
+    config.intra_operators.push_back(std::make_unique<intra_operator::Exchange>());
+    config.intra_operators.push_back(std::make_unique<intra_operator::OrOpt<1>>());
+    config.acceptance_rule
+        = [] { return std::make_unique<acceptance_rule::LateAcceptanceHillClimbing>(83); };
+    config.ruin_method = std::make_unique<ruin_method::SisrsRuin>(36, 8, 0.740, 0.096);
+    config.sorter.AddSortFunction(std::make_unique<sorter::SortByRandom>(), 0.078);
+    config.sorter.AddSortFunction(std::make_unique<sorter::SortByDemand>(), 0.225);
+    config.sorter.AddSortFunction(std::make_unique<sorter::SortByFar>(), 0.942);
+    config.sorter.AddSortFunction(std::make_unique<sorter::SortByClose>(), 0.120);
+    return config;
+  }
+
+  // The customers are points on a grid with Manhattan distances, which satisfy the triangle
+  // inequality. The first point is the depot.
+  Instance MakeGridInstance(const std::vector<std::pair<int, int>> &points,
+                            std::vector<int> demands, int capacity) {
+    Instance instance;
+    instance.num_customers = static_cast<Node>(points.size());
+    instance.capacity = capacity;
+    instance.demands = std::move(demands);
+    instance.distance_matrix.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+      for (auto &&point : points) {
+        instance.distance_matrix[i].push_back(std::abs(points[i].first - point.first)
+                                              + std::abs(points[i].second - point.second));
+      }
+    }
+    return instance;
+  }
+
+  // Customers spread over a grid by a fixed pattern, with demands up to the capacity.
+  Instance MakePatternInstance(Node num_customers) {
+    std::vector<std::pair<int, int>> points;
+    std::vector<int> demands;
+    for (int i = 0; i < num_customers; ++i) {
+      points.emplace_back(i * 37 % 101 - 50, i * 61 % 103 - 51);
+      demands.push_back(i ? i * 13 % 40 + 1 : 0);
+    }
+    return MakeGridInstance(points, demands, 40);
+  }
+
+  // Every demand is served exactly and no route exceeds the capacity.
+  bool IsFeasible(const Instance &instance, const AlkaidSolution &solution) {
+    std::vector<int> loads(instance.num_customers);
+    for (Node node_index : solution.NodeIndices()) {
+      if (solution.Load(node_index) < 0) {
+        return false;
+      }
+      loads[solution.Customer(node_index)] += solution.Load(node_index);
+      if (!solution.Predecessor(node_index)) {
+        int load = 0;
+        for (Node route_node = node_index; route_node; route_node = solution.Successor(route_node)) {
+          load += solution.Load(route_node);
+        }
+        if (load > instance.capacity) {
+          return false;
+        }
+      }
+    }
+    return loads == instance.demands;
+  }
+}  // namespace
 
 TEST_CASE("Large demand") {
   using namespace alkaidsd;
 
-  Config config;
+  AlkaidConfig config;
+  config.random_seed = 42;
   config.time_limit = 1;
   config.blink_rate = 0.01;
   config.inter_operators.push_back(std::make_unique<inter_operator::SwapStar>());
@@ -17,15 +116,122 @@ TEST_CASE("Large demand") {
   config.ruin_method = std::make_unique<ruin_method::RandomRuin>(std::vector{1});
   config.sorter.AddSortFunction(std::make_unique<sorter::SortByRandom>(), 1);
 
-  Problem problem;
-  problem.num_customers = 2;
-  problem.capacity = 1;
-  problem.demands = std::vector{0, 100};
-  problem.distance_matrix = {{0, 1}, {1, 0}};
+  Instance instance;
+  instance.num_customers = 2;
+  instance.capacity = 1;
+  instance.demands = std::vector{0, 100};
+  instance.distance_matrix = {{0, 1}, {1, 0}};
 
-  auto solution = Solve(config, problem);
+  auto solution = AlkaidSolver().Solve(config, instance);
   CHECK(solution.NodeIndices().size() == 100);
-  CHECK(solution.CalcObjective(problem) == 200);
+  CHECK(solution.CalcObjective(instance) == 200);
+}
+
+TEST_CASE("Direct trips with a residual") {
+  using namespace alkaidsd;
+
+  auto config = MakeExampleConfig(42, 0.2);
+  int objective = 0;
+  config.listener = std::make_unique<EndListener>(objective);
+  auto instance = MakeGridInstance({{0, 0}, {3, 4}, {-2, 1}, {5, -1}, {-4, -4}},
+                                   {0, 25, 7, 13, 20}, 10);
+
+  auto solution = AlkaidSolver().Solve(config, instance);
+  CHECK(IsFeasible(instance, solution));
+  CHECK(solution.CalcObjective(instance) == objective);
+}
+
+TEST_CASE("Co-located customers over the capacity") {
+  using namespace alkaidsd;
+
+  auto config = MakeExampleConfig(42, 0.2);
+  int objective = 0;
+  config.listener = std::make_unique<EndListener>(objective);
+  auto instance = MakeGridInstance({{0, 0}, {3, 4}, {-2, 1}, {3, 4}, {5, -1}, {3, 4}},
+                                   {0, 6, 5, 7, 3, 4}, 10);
+
+  auto solution = AlkaidSolver().Solve(config, instance);
+  CHECK(IsFeasible(instance, solution));
+  CHECK(solution.CalcObjective(instance) == objective);
+}
+
+TEST_CASE("Static and dynamic solvers agree") {
+  using namespace alkaidsd;
+
+  // Without time, only the restart candidates are searched, which does not depend on timing.
+  auto instance = MakePatternInstance(40);
+  auto config = MakeExampleConfig(42, 0);
+  config.num_restart_candidates = 3;
+  auto solution = AlkaidSolver().Solve(config, instance);
+  auto static_solution = ExampleConfigSolver().Solve(config, instance);
+  CHECK(IsFeasible(instance, static_solution));
+  CHECK(static_solution.CalcObjective(instance) == solution.CalcObjective(instance));
+
+  config.intra_operators.pop_back();
+  CHECK_THROWS_AS(ExampleConfigSolver().Solve(config, instance), std::invalid_argument);
+}
+
+TEST_CASE("Restart candidates") {
+  using namespace alkaidsd;
+
+  auto instance = MakePatternInstance(40);
+  for (double time_limit : {0.0, 0.2}) {
+    auto config = MakeExampleConfig(42, time_limit);
+    int objective = 0;
+    config.listener = std::make_unique<EndListener>(objective);
+    config.num_threads = 4;
+    config.num_restart_candidates = 3;
+    auto solution = AlkaidSolver().Solve(config, instance);
+    CHECK(IsFeasible(instance, solution));
+    CHECK(solution.CalcObjective(instance) == objective);
+  }
+}
+
+TEST_CASE("Multi-start") {
+  using namespace alkaidsd;
+
+  auto instance = MakePatternInstance(40);
+  for (double time_limit : {0.0, 0.2}) {
+    auto config = MakeExampleConfig(42, time_limit);
+    int objective = 0;
+    config.listener = std::make_unique<EndListener>(objective);
+    config.num_threads = 4;
+    config.multi_start = true;
+    auto solution = AlkaidSolver().Solve(config, instance);
+    CHECK(IsFeasible(instance, solution));
+    CHECK(solution.CalcObjective(instance) == objective);
+  }
+}
+
+TEST_CASE("Short SISR neighbor lists") {
+  using namespace alkaidsd;
+
+  // Few neighbors per customer, so that the ruin often walks past its nearest neighbor lists.
+  auto instance = MakePatternInstance(40);
+  auto config = MakeExampleConfig(42, 0.2);
+  int objective = 0;
+  config.listener = std::make_unique<EndListener>(objective);
+  config.ruin_method = std::make_unique<ruin_method::SisrsRuin>(2, 1, 0.740, 0.096);
+  auto solution = AlkaidSolver().Solve(config, instance);
+  CHECK(IsFeasible(instance, solution));
+  CHECK(solution.CalcObjective(instance) == objective);
+}
+
+TEST_CASE("Reinsertion into candidate routes") {
+  using namespace alkaidsd;
+
+  // With one neighbor, the candidates sometimes lack the spare capacity for a demand, so that the
+  // reinsertion falls back to every route.
+  auto instance = MakePatternInstance(40);
+  for (Node reinsertion_neighbors : {1, 8}) {
+    auto config = MakeExampleConfig(42, 0.2);
+    int objective = 0;
+    config.listener = std::make_unique<EndListener>(objective);
+    config.reinsertion_neighbors = reinsertion_neighbors;
+    auto solution = AlkaidSolver().Solve(config, instance);
+    CHECK(IsFeasible(instance, solution));
+    CHECK(solution.CalcObjective(instance) == objective);
+  }
 }
 
 TEST_CASE("AlkaidSD version") {
@@ -0,0 +1,111 @@
+#include <alkaidsd/config.h>
+#include <doctest/doctest.h>
+
+#include <cstdlib>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "cache.h"
+#include "construction.h"
+#include "operator_selector.h"
+#include "pipeline.h"
+#include "random.h"
+#include "route_context.h"
+#include "speculative_descent.h"
+#include "thread_pool.h"
+
+namespace {
+  using namespace alkaidsd;
+
+  // Random points on a grid with Manhattan distances, so that the triangle inequality holds.
+  Instance MakeRandomInstance(Node num_customers, Random &random) {
+    std::vector<int> xs(num_customers), ys(num_customers);
+    Instance instance;
+    instance.num_customers = num_customers;
+    instance.capacity = 50;
+    instance.demands.resize(num_customers);
+    for (Node i = 0; i < num_customers; ++i) {
+      xs[i] = random.NextInt(-50, 50);
+      ys[i] = random.NextInt(-50, 50);
+      instance.demands[i] = i ? random.NextInt(1, 40) : 0;
+    }
+    instance.distance_matrix.assign(num_customers, std::vector<int>(num_customers));
+    for (Node i = 0; i < num_customers; ++i) {
+      for (Node j = 0; j < num_customers; ++j) {
+        instance.distance_matrix[i][j] = std::abs(xs[i] - xs[j]) + std::abs(ys[i] - ys[j]);
+      }
+    }
+    return instance;
+  }
+
+  // Runs a speculative descent from a constructed solution and returns the customers of the
+  // routes in order, together with the number of applied moves.
+  std::pair<std::vector<Node>, int> Descend(const Instance &instance, const AlkaidConfig &config,
+                                            int num_threads) {
+    DynamicPipeline pipeline(config);
+    Random random(42);
+    auto solution = Construct(instance, random);
+    RouteContext context;
+    context.CalcRouteContext(solution);
+    ThreadPool thread_pool(num_threads);
+    CacheMap cache_map;
+    cache_map.SetThreadPool(thread_pool);
+    // The solver creates the caches by a sequential descent first; one call of every operator on
+    // a copy is enough.
+    for (int k = 0; k < pipeline.NumInterOperators(); ++k) {
+      auto copy = solution;
+      auto copy_context = context;
+      pipeline.Inter(k, instance, copy, copy_context, random, cache_map);
+    }
+    cache_map.Reset(solution, context);
+    Statistics statistics;
+    statistics.inter_operators.resize(config.inter_operators.size());
+    OperatorSelector inter_selector(config.inter_operators.size(), false, 0.99);
+    int num_moves = 0;
+    auto commit = [&](const std::vector<Node> &routes) {
+      ++num_moves;
+      for (Node route_index : routes) {
+        cache_map.RemoveRoute(route_index);
+        if (context.Head(route_index)) {
+          context.UpdateRouteContext(solution, route_index, 0);
+          cache_map.AddRoute(route_index);
+        } else {
+          context.RemoveRoute(route_index);
+        }
+      }
+    };
+    SpeculativeDescent(instance, config, pipeline, solution, context, random, cache_map,
+                       thread_pool, statistics, inter_selector, commit);
+    std::vector<Node> customers;
+    for (Node route_index : context.ActiveRoutes()) {
+      for (Node node_index = context.Head(route_index); node_index;
+           node_index = solution.Successor(node_index)) {
+        customers.push_back(solution.Customer(node_index));
+      }
+      customers.push_back(0);
+    }
+    return {customers, num_moves};
+  }
+}  // namespace
+
+TEST_CASE("Speculative descents do not depend on the thread count") {
+  using namespace alkaidsd;
+
+  AlkaidConfig config;
+  config.inter_operators.push_back(std::make_unique<inter_operator::Relocate>());
+  config.inter_operators.push_back(std::make_unique<inter_operator::Swap<2, 1>>());
+  config.inter_operators.push_back(std::make_unique<inter_operator::Cross>());
+  config.inter_operators.push_back(std::make_unique<inter_operator::SwapStar>());
+  config.inter_operators.push_back(std::make_unique<inter_operator::SdSwapStar>());
+  Random random(7);
+  auto instance = MakeRandomInstance(60, random);
+  for (auto descent_mode : {kSpeculativeBest, kSpeculativeFirst}) {
+    config.descent_mode = descent_mode;
+    auto [customers, num_moves] = Descend(instance, config, 1);
+    CHECK(num_moves > 0);
+    for (int num_threads : {2, 4}) {
+      CHECK(Descend(instance, config, num_threads).first == customers);
+    }
+  }
+}